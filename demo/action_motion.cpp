@@ -11,6 +11,7 @@
 
 #include <boost/multi_array.hpp>
 #include <libaction/human.hpp>
+#include <libaction/image_pool.hpp>
 #include <libaction/motion/multi/serialize.hpp>
 #include <libaction/motion/single/estimator.hpp>
 #include <libaction/still/single/estimator.hpp>
@@ -27,16 +28,18 @@
 #include <utility>
 #include <vector>
 
-static std::unique_ptr<const boost::multi_array<std::uint8_t, 3>> read_image(
+using image_pool_type = libaction::ImagePool<std::uint8_t>;
+
+static image_pool_type::const_image_ptr read_image(
+	image_pool_type &image_pool,
 	const std::string &file, std::size_t height, std::size_t width, std::size_t channels)
 {
 	FILE *f = std::fopen(file.c_str(), "rb");
 	if (!f)
 		throw std::runtime_error("failed to open image file");
 
-	auto image = std::unique_ptr<boost::multi_array<std::uint8_t, 3>>(
-		new boost::multi_array<std::uint8_t, 3>(
-			boost::extents[height][width][channels]));
+	// reuse an image released by the motion estimator
+	auto image = image_pool.acquire(height, width, channels);
 	auto count = std::fread(image->data(), image->num_elements(), 1, f);
 
 	std::fclose(f);
@@ -44,17 +47,18 @@ static std::unique_ptr<const boost::multi_array<std::uint8_t, 3>> read_image(
 	if (count < 1)
 		throw std::runtime_error("image file too small");
 
-	return image;
+	return image_pool_type::const_image_ptr(std::move(image));
 }
 
-static std::unique_ptr<const boost::multi_array<std::uint8_t, 3>> motion_callback(
+static image_pool_type::const_image_ptr motion_callback(
+	image_pool_type &image_pool,
 	const std::string &image_file_prefix,
 	const std::string &image_file_suffix,
 	std::size_t image_height, std::size_t image_width, std::size_t channels,
 	std::size_t pos, bool /* last_image_access */
 ) {
 	// read the image
-	auto image = read_image(
+	auto image = read_image(image_pool,
 		image_file_prefix + std::to_string(pos) + image_file_suffix,
 		image_height, image_width, channels);
 	return image;
@@ -121,29 +125,31 @@ int main(int argc, char *argv[])
 		libaction::motion::single::Estimator motion_estimator;
 
 		// initialize the callback
+		image_pool_type image_pool;
 		using callback_type = std::function<
-			std::unique_ptr<const boost::multi_array<std::uint8_t, 3>>(
+			image_pool_type::const_image_ptr(
 				std::size_t pos, bool last_image_access)>;
 		callback_type callback(std::bind(
-			&motion_callback,
+			&motion_callback, std::ref(image_pool),
 			image_file_prefix, image_file_suffix,
 			image_height, image_width, channels,
 			std::placeholders::_1, std::placeholders::_2));
 
-		std::list<std::unordered_map<std::size_t, libaction::Human>> action;
-
 		auto time_before = std::chrono::steady_clock::now();
 
-		for (std::size_t i = 0; i < num_images; i++) {
-			// do estimation
-			auto humans = motion_estimator.estimate(i, num_images,
-				fuzz_range, { }, true,
-				zoom, zoom_range, zoom_rate,
-				still_estimator_ptrs, still_estimator_ptrs, callback);
+		// do estimation
+		auto action = motion_estimator.estimate_all(num_images,
+			fuzz_range, { }, true,
+			zoom, zoom_range, zoom_rate,
+			still_estimator_ptrs, still_estimator_ptrs, callback);
+
+		auto time_after = std::chrono::steady_clock::now();
 
-			// show results
+		// show results
+		std::size_t i = 0;
+		for (auto &humans: *action) {
 			std::cout << "======== Image #" << i << " ========" << std::endl;
-			for (auto &human: *humans) {
+			for (auto &human: humans) {
 				std::cout << "Human #" << human.first << std::endl;
 				auto &body_parts = human.second.body_parts();
 				for (auto &part: body_parts) {
@@ -153,14 +159,11 @@ int main(int argc, char *argv[])
 				}
 			}
 			std::cout << std::endl;
-
-			action.push_back(std::move(*humans));
+			i++;
 		}
 
-		auto time_after = std::chrono::steady_clock::now();
-
 		if (!save_file.empty()) {
-			auto se = libaction::motion::multi::serialize::serialize(action);
+			auto se = libaction::motion::multi::serialize::serialize(*action);
 
 			FILE *f = std::fopen(save_file.c_str(), "wb");
 			if (f) {
@@ -10,6 +10,7 @@
  */
 
 #include <libaction/body_part.hpp>
+#include <libaction/motion/multi/action_sequence.hpp>
 #include <libaction/motion/multi/deserialize.hpp>
 #include <libaction/still/single/score.hpp>
 #include <cstdint>
@@ -62,10 +63,12 @@ int main(int argc, char *argv[])
 		auto sample_data = read_file(sample_file, max);
 		auto standard_data = read_file(standard_file, max);
 
-		auto sample =
-			libaction::motion::multi::deserialize::deserialize(*sample_data);
-		auto standard =
-			libaction::motion::multi::deserialize::deserialize(*standard_data);
+		using libaction::motion::multi::ActionSequence;
+
+		auto sample = libaction::motion::multi::deserialize::
+			deserialize<ActionSequence>(*sample_data);
+		auto standard = libaction::motion::multi::deserialize::
+			deserialize<ActionSequence>(*standard_data);
 
 		std::map<std::pair<libaction::BodyPart::PartIndex,
 			libaction::BodyPart::PartIndex>, std::uint64_t> part_sums;
@@ -74,28 +77,19 @@ int main(int argc, char *argv[])
 		std::uint64_t frame_sum = 0;
 		std::uint32_t frame_count = 0;
 
-		auto sample_it = sample->begin();
-		auto standard_it = standard->begin();
-
 		for (std::size_t i = 0; i < sample->size() && i < standard->size();
-			i++, sample_it++, standard_it++)
+			i++)
 		{
-			auto &sample_frame = *sample_it;
-			auto &standard_frame = *standard_it;
-
-			auto human1_it = sample_frame.find(0);
-			if (human1_it == sample_frame.end())
+			auto human1 = sample->frame(i).find(0);
+			if (!human1)
 				continue;
 
-			auto human2_it = standard_frame.find(0);
-			if (human2_it == standard_frame.end())
+			auto human2 = standard->frame(i).find(0);
+			if (!human2)
 				continue;
 
-			auto &human1 = human1_it->second;
-			auto &human2 = human2_it->second;
-
 			auto scores = libaction::still::single::score::score(
-				human1, human2);
+				*human1, *human2);
 
 			std::uint32_t sum = 0;
 			std::cout << "======== Image #" << i << " ========" << std::endl;
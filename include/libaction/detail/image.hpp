@@ -10,9 +10,12 @@
 
 #include <boost/multi_array.hpp>
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace libaction
 {
@@ -126,6 +129,72 @@ std::unique_ptr<boost::multi_array<typename Input::element, 3>> crop(
 	return target_image;
 }
 
+/// Get a thumbnail of an image, which serves as a cheap signature of it.
+
+/// The image is divided into a grid of `size` * `size` cells, and every
+/// channel is averaged within each cell.
+///
+/// @param[in]  image       The input image conforming to the Boost.MultiArray
+///                         concept. The image must have 3 non-empty
+///                         dimensions of height, width, and channels.
+/// @param[in]  size        The number of cells along each side (>0).
+/// @return                 The averages by cell row, cell column and channel.
+/// @exception              std::runtime_error
+template<typename Input>
+std::vector<float> thumbnail(const Input &image, std::size_t size)
+{
+	if (image.num_dimensions() != 3 ||
+			image.shape()[0] == 0 || image.shape()[1] == 0 ||
+			image.shape()[2] == 0 || size == 0)
+		throw std::runtime_error("invalid image parameters");
+
+	auto height = image.shape()[0];
+	auto width = image.shape()[1];
+	auto channels = image.shape()[2];
+
+	std::vector<float> sums(size * size * channels, 0.0f);
+	std::vector<std::size_t> counts(size * size, 0);
+
+	for (std::size_t i = 0; i < height; i++) {
+		std::size_t row = i * size / height;
+		for (std::size_t j = 0; j < width; j++) {
+			std::size_t cell = row * size + j * size / width;
+			for (std::size_t k = 0; k < channels; k++)
+				sums[cell * channels + k] += static_cast<float>(image[i][j][k]);
+			counts[cell]++;
+		}
+	}
+
+	for (std::size_t cell = 0; cell < size * size; cell++) {
+		if (counts[cell] == 0)
+			continue;
+		for (std::size_t k = 0; k < channels; k++)
+			sums[cell * channels + k] /= static_cast<float>(counts[cell]);
+	}
+
+	return sums;
+}
+
+/// The mean absolute difference between two thumbnails.
+
+/// @return                 The difference, or infinity if the thumbnails
+///                         have different sizes.
+/// @sa                     thumbnail
+inline float thumbnail_difference(const std::vector<float> &thumbnail1,
+	const std::vector<float> &thumbnail2)
+{
+	if (thumbnail1.size() != thumbnail2.size())
+		return std::numeric_limits<float>::infinity();
+	if (thumbnail1.empty())
+		return 0.0f;
+
+	float difference = 0.0f;
+	for (std::size_t i = 0; i < thumbnail1.size(); i++)
+		difference += std::fabs(thumbnail1[i] - thumbnail2[i]);
+
+	return difference / static_cast<float>(thumbnail1.size());
+}
+
 }
 }
 }
@@ -0,0 +1,118 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__DETAIL__PACKED_HUMAN_HPP_
+#define LIBACTION__DETAIL__PACKED_HUMAN_HPP_
+
+#include "../body_part.hpp"
+#include "../human.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+namespace libaction
+{
+namespace detail
+{
+
+/// Fixed-size, quantized encoding of a human pose.
+
+/// Coordinates are stored as 16-bit fixed-point numbers covering
+/// [coord_min, coord_max], and scores as 8-bit fixed-point numbers covering
+/// [0.0, 1.0]. Values out of range are clamped. A bitmap records which parts
+/// exist.
+class PackedHuman
+{
+public:
+	static constexpr std::size_t parts_size =
+		static_cast<std::size_t>(libaction::BodyPart::PartIndex::end);
+
+	static_assert(parts_size <= 32, "parts_size <= 32");
+
+	inline PackedHuman() {}
+
+	inline explicit PackedHuman(const libaction::Human &human)
+	{
+		for (auto &part: human.body_parts()) {
+			auto i = static_cast<std::size_t>(part.first);
+			if (i >= parts_size)
+				continue;
+
+			mask_ |= (1UL << i);
+			x_[i] = pack_coord(part.second.x());
+			y_[i] = pack_coord(part.second.y());
+			score_[i] = pack_score(part.second.score());
+		}
+	}
+
+	inline std::unique_ptr<libaction::Human> unpack() const
+	{
+		std::list<libaction::BodyPart> parts;
+		for (std::size_t i = 0; i < parts_size; i++) {
+			if ((mask_ & (1UL << i)) == 0)
+				continue;
+
+			parts.push_back(libaction::BodyPart(
+				static_cast<libaction::BodyPart::PartIndex>(i),
+				unpack_coord(x_[i]), unpack_coord(y_[i]),
+				unpack_score(score_[i])));
+		}
+
+		return std::unique_ptr<libaction::Human>(new libaction::Human(parts));
+	}
+
+private:
+	static constexpr float coord_min = -0.5f;
+	static constexpr float coord_max = 1.5f;
+
+	std::array<std::uint16_t, parts_size> x_{}, y_{};
+	std::array<std::uint8_t, parts_size> score_{};
+	std::uint32_t mask_{};
+
+	static inline std::uint16_t pack_coord(float value)
+	{
+		if (std::isnan(value))
+			value = 0.0f;
+		if (value < coord_min)
+			value = coord_min;
+		else if (value > coord_max)
+			value = coord_max;
+
+		return static_cast<std::uint16_t>(std::lround(
+			(value - coord_min) / (coord_max - coord_min) * 65535.0f));
+	}
+
+	static inline float unpack_coord(std::uint16_t value)
+	{
+		return coord_min +
+			static_cast<float>(value) / 65535.0f * (coord_max - coord_min);
+	}
+
+	static inline std::uint8_t pack_score(float value)
+	{
+		if (std::isnan(value))
+			value = 0.0f;
+		value = std::min(std::max(value, +0.0f), 1.0f);
+
+		return static_cast<std::uint8_t>(std::lround(value * 255.0f));
+	}
+
+	static inline float unpack_score(std::uint8_t value)
+	{
+		return static_cast<float>(value) / 255.0f;
+	}
+};
+
+}
+}
+
+#endif
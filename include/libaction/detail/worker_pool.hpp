@@ -0,0 +1,153 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__DETAIL__WORKER_POOL_HPP_
+#define LIBACTION__DETAIL__WORKER_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace detail
+{
+
+/// A fixed set of long-lived worker threads.
+
+/// Workers are parked between jobs. A job is run once on every worker, with
+/// the index of the worker as the argument, so that each worker can be bound
+/// to its own resources.
+class WorkerPool
+{
+public:
+	/// Start the workers.
+
+	/// @param[in]  size        The number of workers.
+	inline explicit WorkerPool(std::size_t size)
+	{
+		threads.reserve(size);
+		for (std::size_t i = 0; i < size; i++)
+			threads.push_back(std::thread(&WorkerPool::work, this, i));
+	}
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/// Wait for the current job, if any, and stop the workers.
+	inline ~WorkerPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		cv.notify_all();
+
+		for (auto &thread: threads)
+			thread.join();
+	}
+
+	/// The number of workers.
+
+	/// @return                 The number of workers.
+	inline std::size_t size() const
+	{
+		return threads.size();
+	}
+
+	/// Start a job on every worker without waiting for it.
+
+	/// @param[in]  job         The job, called with the index of the worker.
+	/// @exception              std::runtime_error
+	inline void start(std::function<void(std::size_t worker)> job)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (running != 0)
+				throw std::runtime_error("worker pool is busy");
+
+			current_job = std::move(job);
+			error = nullptr;
+			running = threads.size();
+			generation++;
+		}
+		cv.notify_all();
+	}
+
+	/// Wait for the job to finish on every worker.
+
+	/// The first exception thrown from the job, if any, is rethrown.
+	inline void wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done_cv.wait(lock, [this] { return running == 0; });
+
+		if (error) {
+			auto e = error;
+			error = nullptr;
+			std::rethrow_exception(e);
+		}
+	}
+
+private:
+	std::vector<std::thread> threads{};
+
+	std::mutex mutex{};
+	std::condition_variable cv{}, done_cv{};
+
+	std::function<void(std::size_t)> current_job{};
+	std::exception_ptr error{};
+	std::size_t running = 0;
+	std::size_t generation = 0;
+	bool stopping = false;
+
+	inline void work(std::size_t index)
+	{
+		std::size_t done_generation = 0;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [this, done_generation] {
+					return stopping || generation != done_generation;
+				});
+				if (generation == done_generation)
+					return;
+				done_generation = generation;
+			}
+
+			// current_job is not modified until every worker is done
+			try {
+				current_job(index);
+			} catch (...) {
+				std::unique_lock<std::mutex> lock(mutex);
+				if (!error)
+					error = std::current_exception();
+			}
+
+			bool done;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				running--;
+				done = (running == 0);
+			}
+			if (done)
+				done_cv.notify_all();
+		}
+	}
+};
+
+}
+}
+
+#endif
@@ -9,16 +9,49 @@
 #define LIBACTION__HUMAN_HPP_
 
 #include "body_part.hpp"
+#include "skeleton.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <unordered_map>
 
 namespace libaction
 {
 
 /// Describe a human pose.
+
+/// Geometry derived from the body parts is computed on first use and cached
+/// until the body parts are accessed through the non-const body_parts().
+/// Filling the cache modifies the human, so a single human is not thread safe
+/// unless its geometry has been computed.
 class Human
 {
 public:
+	/// Geometry derived from the body parts.
+
+	/// All values are 0 if there is no body part.
+	struct Geometry
+	{
+		/// The minimum x coordinate of all body parts.
+		float x1;
+		/// The maximum x coordinate of all body parts.
+		float x2;
+		/// The minimum y coordinate of all body parts.
+		float y1;
+		/// The maximum y coordinate of all body parts.
+		float y2;
+		/// The mean x coordinate of all body parts.
+		float mid_x;
+		/// The mean y coordinate of all body parts.
+		float mid_y;
+		/// The range of x coordinates of all body parts, or `sig_y_range` if
+		/// the range is 0.
+		float sig_x_range;
+		/// The range of y coordinates of body parts except for
+		/// skeleton::Coco18::limbs, or `sig_x_range` if the range is 0.
+		float sig_y_range;
+	};
+
 	/// Construct from a list of BodyPart.
 
 	/// @param[in]  parts       An iterable representing a list of BodyPart.
@@ -43,17 +76,91 @@ public:
 
 	/// Body parts.
 
+	/// The cached geometry is invalidated. The returned reference must not be
+	/// used to modify body parts after geometry() is called.
+
 	/// @return                 An unordered map mapping part index to its
 	///                         respective body part.
 	/// @sa                     BodyPart::PartIndex and BodyPart
 	inline std::unordered_map<BodyPart::PartIndex, BodyPart> &body_parts()
 	{
+		geometry_valid_ = false;
 		return body_parts_;
 	}
 
+	/// Geometry derived from the body parts.
+
+	/// @return                 The geometry, which remains valid until the
+	///                         human is modified.
+	inline const Geometry &geometry() const
+	{
+		if (!geometry_valid_) {
+			geometry_ = compute_geometry();
+			geometry_valid_ = true;
+		}
+		return geometry_;
+	}
 
 private:
 	std::unordered_map<BodyPart::PartIndex, BodyPart> body_parts_{};
+	mutable Geometry geometry_{};
+	mutable bool geometry_valid_ = false;
+
+	inline Geometry compute_geometry() const
+	{
+		if (body_parts_.empty())
+			return Geometry{};
+
+		auto &first = body_parts_.begin()->second;
+		float x1 = first.x(), x2 = first.x(), y1 = first.y(), y2 = first.y();
+		float mid_x = 0.0f, mid_y = 0.0f;
+
+		// ranges of significant coordinates
+		float x_min = first.x(), x_max = first.x();
+		float y_min = 0.0f, y_max = 0.0f;
+		std::size_t y_size = 0;
+
+		auto size = static_cast<float>(body_parts_.size());
+
+		for (auto &part: body_parts_) {
+			float x = part.second.x(), y = part.second.y();
+
+			x1 = std::min(x1, x);
+			x2 = std::max(x2, x);
+			y1 = std::min(y1, y);
+			y2 = std::max(y2, y);
+
+			mid_x += x / size;
+			mid_y += y / size;
+
+			if (!(x <= x_max))
+				x_max = x;
+			if (!(x >= x_min))
+				x_min = x;
+
+			if ((skeleton::mask(part.first) & skeleton::Coco18::limbs) == 0) {
+				if (y_size == 0) {
+					y_min = y_max = y;
+				} else {
+					if (!(y <= y_max))
+						y_max = y;
+					if (!(y >= y_min))
+						y_min = y;
+				}
+				y_size++;
+			}
+		}
+
+		float x_range = body_parts_.size() < 2 ? 0.0f : x_max - x_min;
+		float y_range = y_size < 2 ? 0.0f : y_max - y_min;
+
+		if (x_range == 0.0f)
+			x_range = y_range;
+		else if (y_range == 0.0f)
+			y_range = x_range;
+
+		return Geometry{ x1, x2, y1, y2, mid_x, mid_y, x_range, y_range };
+	}
 };
 
 }
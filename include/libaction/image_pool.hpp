@@ -0,0 +1,164 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__IMAGE_POOL_HPP_
+#define LIBACTION__IMAGE_POOL_HPP_
+
+#include <boost/multi_array.hpp>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace libaction
+{
+
+/// Pool of reusable image buffers.
+
+/// Images acquired from the pool are returned to it when their pointers are
+/// destroyed, instead of being freed. A motion estimator destroys an image as
+/// soon as it is no longer needed, so image callbacks can fill pooled images
+/// and allocate nothing once the pool has warmed up. Images may be acquired
+/// and returned concurrently from different threads, and may outlive the
+/// pool, in which case they are freed.
+///
+/// @tparam     Element     The element type of images.
+template<typename Element>
+class ImagePool
+{
+	class State;
+
+public:
+	/// The image type.
+	using image_type = boost::multi_array<Element, 3>;
+
+	/// Deleter returning images to the pool.
+	class Recycler
+	{
+	public:
+		/// Construct without a pool. Images are freed.
+		inline Recycler() {}
+
+		/// Construct for a pool.
+		inline explicit Recycler(const std::weak_ptr<State> &state)
+		:
+		state(state)
+		{}
+
+		/// Return an image to the pool, or free it if the pool is gone.
+		inline void operator()(const image_type *image) const
+		{
+			auto pool = state.lock();
+			if (pool) {
+				pool->put(std::unique_ptr<image_type>(
+					const_cast<image_type *>(image)));
+			} else {
+				delete image;
+			}
+		}
+
+	private:
+		std::weak_ptr<State> state{};
+	};
+
+	/// Pointer to a pooled image.
+	using image_ptr = std::unique_ptr<image_type, Recycler>;
+
+	/// Pointer to a pooled constant image.
+	using const_image_ptr = std::unique_ptr<const image_type, Recycler>;
+
+	/// Construct an empty pool.
+	inline ImagePool()
+	{}
+
+	/// Acquire an image, reusing a returned one if possible.
+
+	/// The content of the image is unspecified.
+	///
+	/// @param[in]  height      The height of the image.
+	/// @param[in]  width       The width of the image.
+	/// @param[in]  channels    The number of channels of the image.
+	/// @return                 The image.
+	inline image_ptr acquire(std::size_t height, std::size_t width,
+		std::size_t channels)
+	{
+		auto image = state->get(height, width, channels);
+		if (!image) {
+			image = std::unique_ptr<image_type>(new image_type(
+				boost::extents[height][width][channels]));
+		}
+
+		return image_ptr(image.release(), Recycler(state));
+	}
+
+	/// The number of images available for reuse.
+
+	/// @return                 The number of images returned and not yet
+	///                         acquired again.
+	inline std::size_t idle() const
+	{
+		return state->size();
+	}
+
+	/// Free all images available for reuse.
+	inline void clear()
+	{
+		state->clear();
+	}
+
+private:
+	class State
+	{
+	public:
+		inline void put(std::unique_ptr<image_type> image)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			images.push_back(std::move(image));
+		}
+
+		inline std::unique_ptr<image_type> get(std::size_t height,
+			std::size_t width, std::size_t channels)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			for (auto it = images.begin(); it != images.end(); it++) {
+				auto shape = (*it)->shape();
+				if (shape[0] == height && shape[1] == width &&
+						shape[2] == channels) {
+					auto image = std::move(*it);
+					images.erase(it);
+					return image;
+				}
+			}
+
+			return std::unique_ptr<image_type>();
+		}
+
+		inline std::size_t size()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			return images.size();
+		}
+
+		inline void clear()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			images.clear();
+		}
+
+	private:
+		std::mutex mutex{};
+		std::list<std::unique_ptr<image_type>> images{};
+	};
+
+	std::shared_ptr<State> state{ std::make_shared<State>() };
+};
+
+}
+
+#endif
@@ -0,0 +1,478 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__MULTI__ACTION_SEQUENCE_HPP_
+#define LIBACTION__MOTION__MULTI__ACTION_SEQUENCE_HPP_
+
+#include "../../body_part.hpp"
+#include "../../human.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace multi
+{
+
+/// Compact storage of action data for multiple persons.
+
+/// The poses of all frames are stored in contiguous buffers, frame after
+/// frame, along with the index identifying each person. Each pose takes a
+/// presence bitmap, in which bit `i` is set if the part with index `i`
+/// exists, and a fixed block of `parts_size` parts, so no hash map is built
+/// per pose. A table of offsets locates the poses of every frame in the
+/// buffers (the CSR layout), so any frame can be accessed in constant time.
+/// libaction::Human objects are only built when requested.
+class ActionSequence
+{
+public:
+	/// The number of body parts stored for each pose.
+	static constexpr std::size_t parts_size =
+		static_cast<std::size_t>(libaction::BodyPart::PartIndex::end);
+
+	static_assert(parts_size < 32, "parts_size < 32");
+
+	/// A stored body part. Values of absent parts are 0.
+	struct Part
+	{
+		float x;
+		float y;
+		float score;
+	};
+
+	/// A view of the indexed poses in one frame.
+
+	/// The view is invalidated when the ActionSequence is modified.
+	class Frame
+	{
+	public:
+		/// Construct from a range of the buffers.
+		inline Frame(const std::uint32_t *masks, const Part *parts,
+			const std::size_t *indices, std::size_t size)
+		:
+		masks_(masks), parts_(parts), indices_(indices), size_(size)
+		{}
+
+		/// The number of poses in the frame.
+
+		/// @return                 The number of poses in the frame.
+		inline std::size_t size() const { return size_; }
+
+		/// Whether the frame contains no pose.
+
+		/// @return                 Whether the frame contains no pose.
+		inline bool empty() const { return size_ == 0; }
+
+		/// The index of the person at a position of the frame.
+
+		/// @param[in]  pos         The position within the frame. Must be
+		///                         less than size().
+		/// @return                 The index of the person at `pos`.
+		inline std::size_t index(std::size_t pos) const
+		{
+			return indices_[pos];
+		}
+
+		/// The presence bitmap of the pose at a position of the frame.
+
+		/// @param[in]  pos         The position within the frame. Must be
+		///                         less than size().
+		/// @return                 The bitmap, in which bit `i` is set if the
+		///                         part with index `i` exists.
+		inline std::uint32_t mask(std::size_t pos) const
+		{
+			return masks_[pos];
+		}
+
+		/// Whether a body part exists in the pose at a position of the frame.
+
+		/// @param[in]  pos         The position within the frame. Must be
+		///                         less than size().
+		/// @param[in]  part        The index of the body part.
+		/// @return                 Whether the part exists.
+		inline bool has_part(std::size_t pos,
+			libaction::BodyPart::PartIndex part) const
+		{
+			auto i = static_cast<std::size_t>(part);
+			return i < parts_size && (masks_[pos] & (1UL << i)) != 0;
+		}
+
+		/// A body part of the pose at a position of the frame.
+
+		/// @param[in]  pos         The position within the frame. Must be
+		///                         less than size().
+		/// @param[in]  part        The index of the body part, which must
+		///                         exist.
+		/// @return                 The body part.
+		inline libaction::BodyPart part(std::size_t pos,
+			libaction::BodyPart::PartIndex part) const
+		{
+			auto &value = parts_[pos * parts_size +
+				static_cast<std::size_t>(part)];
+			return libaction::BodyPart(part, value.x, value.y, value.score);
+		}
+
+		/// Build the human at a position of the frame.
+
+		/// @param[in]  pos         The position within the frame. Must be
+		///                         less than size().
+		/// @return                 The human at `pos`.
+		inline std::unique_ptr<libaction::Human> human(std::size_t pos) const
+		{
+			std::vector<libaction::BodyPart> parts;
+			for (std::size_t i = 0; i < parts_size; i++) {
+				if ((masks_[pos] & (1UL << i)) == 0)
+					continue;
+
+				parts.push_back(part(pos,
+					static_cast<libaction::BodyPart::PartIndex>(i)));
+			}
+
+			return std::unique_ptr<libaction::Human>(
+				new libaction::Human(parts));
+		}
+
+		/// Whether a person exists in the frame.
+
+		/// @param[in]  index       The index of the person.
+		/// @return                 Whether the person exists.
+		inline bool contains(std::size_t index) const
+		{
+			return position(index) != size_;
+		}
+
+		/// Find a person by index.
+
+		/// @param[in]  index       The index of the person.
+		/// @return                 The human built from the pose, or `nullptr`
+		///                         if the person does not exist in the frame.
+		inline std::unique_ptr<libaction::Human> find(std::size_t index) const
+		{
+			std::size_t pos = position(index);
+			if (pos == size_)
+				return nullptr;
+			return human(pos);
+		}
+
+	private:
+		const std::uint32_t *masks_;
+		const Part *parts_;
+		const std::size_t *indices_;
+		std::size_t size_;
+
+		inline std::size_t position(std::size_t index) const
+		{
+			for (std::size_t i = 0; i < size_; i++) {
+				if (indices_[i] == index)
+					return i;
+			}
+			return size_;
+		}
+	};
+
+	/// Iterator over the frames of an ActionSequence.
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Frame;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Frame *;
+		using reference = Frame;
+
+		/// Construct from a sequence and a frame number.
+		inline const_iterator(const ActionSequence *sequence, std::size_t pos)
+		:
+		sequence_(sequence), pos_(pos)
+		{}
+
+		/// The current frame.
+		inline Frame operator*() const { return sequence_->frame(pos_); }
+
+		/// Advance to the next frame.
+		inline const_iterator &operator++()
+		{
+			pos_++;
+			return *this;
+		}
+
+		/// Advance to the next frame.
+		inline const_iterator operator++(int)
+		{
+			const_iterator old = *this;
+			pos_++;
+			return old;
+		}
+
+		/// Equality.
+		inline bool operator==(const const_iterator &other) const
+		{
+			return sequence_ == other.sequence_ && pos_ == other.pos_;
+		}
+
+		/// Inequality.
+		inline bool operator!=(const const_iterator &other) const
+		{
+			return !(*this == other);
+		}
+
+	private:
+		const ActionSequence *sequence_;
+		std::size_t pos_;
+	};
+
+	/// Construct an empty sequence.
+	inline ActionSequence() {}
+
+	/// Construct from action data.
+
+	/// @param[in]  action      Action data of the format
+	///                         List<Map<Index, libaction::Human>>, where
+	///                         `List` is an iterable of `Map`, `Map` is an
+	///                         iterable of `std::pair<Index, libaction::Human>`,
+	///                         and `Index` is an unsigned integral identifying
+	///                         each person.
+	template<typename Action>
+	inline explicit ActionSequence(const Action &action)
+	{
+		offsets_.reserve(action.size() + 1);
+		for (auto &human_map: action) {
+			push_back(human_map);
+		}
+	}
+
+	/// The number of frames.
+
+	/// @return                 The number of frames.
+	inline std::size_t size() const
+	{
+		return offsets_.size() - 1;
+	}
+
+	/// Whether the sequence contains no frame.
+
+	/// @return                 Whether the sequence contains no frame.
+	inline bool empty() const
+	{
+		return size() == 0;
+	}
+
+	/// Reserve storage.
+
+	/// @param[in]  frames      The number of frames to reserve storage for.
+	/// @param[in]  humans      The total number of poses to reserve storage
+	///                         for.
+	inline void reserve(std::size_t frames, std::size_t humans)
+	{
+		offsets_.reserve(frames + 1);
+		masks_.reserve(humans);
+		parts_.reserve(humans * parts_size);
+		indices_.reserve(humans);
+	}
+
+	/// Remove all frames.
+	inline void clear()
+	{
+		masks_.clear();
+		parts_.clear();
+		indices_.clear();
+		offsets_.assign(1, 0);
+	}
+
+	/// Append an empty frame.
+	inline void push_frame()
+	{
+		offsets_.push_back(indices_.size());
+	}
+
+	/// Append a pose without body parts to the last frame.
+
+	/// Body parts may then be added with set_part().
+	///
+	/// @param[in]  index       The index of the person.
+	/// @exception              std::runtime_error
+	inline void push_human(std::size_t index)
+	{
+		if (empty())
+			throw std::runtime_error("no frame to push to");
+
+		masks_.push_back(0);
+		parts_.resize(parts_.size() + parts_size, Part{ 0.0f, 0.0f, 0.0f });
+		indices_.push_back(index);
+		offsets_.back() = indices_.size();
+	}
+
+	/// Append a human to the last frame.
+
+	/// @param[in]  index       The index of the person.
+	/// @param[in]  human       The human.
+	/// @exception              std::runtime_error
+	inline void push_human(std::size_t index, const libaction::Human &human)
+	{
+		push_human(index);
+		for (auto &part: human.body_parts()) {
+			set_part(part.first, part.second.x(), part.second.y(),
+				part.second.score());
+		}
+	}
+
+	/// Set a body part of the last pose.
+
+	/// @param[in]  part        The index of the body part. Parts out of range
+	///                         are ignored.
+	/// @param[in]  x           The x coordinate.
+	/// @param[in]  y           The y coordinate.
+	/// @param[in]  score       The score.
+	/// @exception              std::runtime_error
+	inline void set_part(libaction::BodyPart::PartIndex part,
+		float x, float y, float score)
+	{
+		if (masks_.empty())
+			throw std::runtime_error("no pose to set");
+
+		auto i = static_cast<std::size_t>(part);
+		if (i >= parts_size)
+			return;
+
+		masks_.back() |= (1UL << i);
+		parts_[(masks_.size() - 1) * parts_size + i] = Part{ x, y, score };
+	}
+
+	/// Append a frame.
+
+	/// @param[in]  human_map   An iterable of
+	///                         `std::pair<Index, libaction::Human>`, where
+	///                         `Index` is an unsigned integral identifying
+	///                         each person.
+	template<typename HumanMap>
+	inline void push_back(const HumanMap &human_map)
+	{
+		push_frame();
+		for (auto &human_pair: human_map) {
+			push_human(static_cast<std::size_t>(human_pair.first),
+				human_pair.second);
+		}
+	}
+
+	/// The poses of a frame.
+
+	/// @param[in]  pos         The index of the frame. Must be less than
+	///                         size().
+	/// @return                 A view of the frame.
+	inline Frame frame(std::size_t pos) const
+	{
+		std::size_t begin = offsets_[pos];
+		std::size_t end = offsets_[pos + 1];
+		return Frame(masks_.data() + begin, parts_.data() + begin * parts_size,
+			indices_.data() + begin, end - begin);
+	}
+
+	/// The poses of a frame.
+
+	/// @param[in]  pos         The index of the frame. Must be less than
+	///                         size().
+	/// @return                 A view of the frame.
+	inline Frame operator[](std::size_t pos) const
+	{
+		return frame(pos);
+	}
+
+	/// Iterator to the first frame.
+	inline const_iterator begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	/// Iterator past the last frame.
+	inline const_iterator end() const
+	{
+		return const_iterator(this, size());
+	}
+
+	/// The buffer of presence bitmaps.
+
+	/// @return                 The bitmap of each pose of all frames, frame
+	///                         after frame.
+	inline const std::vector<std::uint32_t> &masks() const
+	{
+		return masks_;
+	}
+
+	/// The buffer of body parts.
+
+	/// @return                 Body parts of all poses, `parts_size` per pose.
+	///                         Part `j` of pose `i` is at
+	///                         `parts()[i * parts_size + j]`.
+	inline const std::vector<Part> &parts() const
+	{
+		return parts_;
+	}
+
+	/// The buffer of all person indices.
+
+	/// @return                 Indices of the persons in masks().
+	inline const std::vector<std::size_t> &indices() const
+	{
+		return indices_;
+	}
+
+	/// The table of frame offsets.
+
+	/// @return                 Offsets into masks() and indices(). The poses
+	///                         of frame `i` are within
+	///                         [offsets()[i], offsets()[i + 1]).
+	inline const std::vector<std::size_t> &offsets() const
+	{
+		return offsets_;
+	}
+
+	/// Convert to a frame list of indexed humans.
+
+	/// @return                 Action data as a frame list of indexed humans.
+	inline std::unique_ptr<std::list<std::unordered_map<
+		std::size_t, libaction::Human>>>
+	to_action() const
+	{
+		auto action = std::unique_ptr<std::list<std::unordered_map<
+			std::size_t, libaction::Human>>>(
+				new std::list<std::unordered_map<
+					std::size_t, libaction::Human>>());
+
+		for (std::size_t i = 0; i < size(); i++) {
+			auto current = frame(i);
+			action->emplace_back();
+			for (std::size_t j = 0; j < current.size(); j++) {
+				action->back().insert(std::make_pair(current.index(j),
+					std::move(*current.human(j))));
+			}
+		}
+
+		return action;
+	}
+
+private:
+	std::vector<std::uint32_t> masks_{};
+	std::vector<Part> parts_{};
+	std::vector<std::size_t> indices_{};
+	std::vector<std::size_t> offsets_{ 0 };
+};
+
+}
+}
+}
+
+#endif
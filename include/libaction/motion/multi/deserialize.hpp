@@ -9,6 +9,7 @@
 #define LIBACTION__MOTION__MULTI__DESERIALIZE_HPP_
 
 #include "../../human.hpp"
+#include "action_sequence.hpp"
 #include "deserialize/detail.hpp"
 
 #include <cstdint>
@@ -28,14 +29,18 @@ namespace deserialize
 
 /// Deserialize action data from bytes.
 
+/// @tparam     Action      The type of the result. Either a list of
+///                         `std::unordered_map<std::size_t, libaction::Human>`
+///                         (the default) or ActionSequence, which is read
+///                         directly into its contiguous buffers.
 /// @param[in]  data        Action data in bytes in a standard container.
 /// @param[in]  magic       Whether the magic number is included in `data`.
 /// @return                 Deserialized action data as a frame list of indexed
 ///                         humans. Index starts from 0.
 /// @exception              std::runtime_error
-template<typename Data>
-inline std::unique_ptr<std::list<std::unordered_map<
-	std::size_t, libaction::Human>>>
+template<typename Action = std::list<std::unordered_map<
+	std::size_t, libaction::Human>>, typename Data>
+inline std::unique_ptr<Action>
 deserialize(const Data &data, bool magic = true)
 {
 	typename Data::const_iterator it = data.begin();
@@ -47,12 +52,10 @@ deserialize(const Data &data, bool magic = true)
 	if (action_size >= detail::max)
 		throw std::runtime_error("too many items");
 
-	auto action = std::unique_ptr<std::list<std::unordered_map<
-		std::size_t, libaction::Human>>>(
-			new std::list<std::unordered_map<std::size_t, libaction::Human>>());
+	auto action = std::unique_ptr<Action>(new Action());
 
 	for (std::uint32_t i = 0; i < action_size; i++) {
-		action->push_back(detail::read_human_map(it, data.end()));
+		detail::read_frame(it, data.end(), *action);
 	}
 
 	return action;
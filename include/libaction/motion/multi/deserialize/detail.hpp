@@ -12,6 +12,7 @@
 #include "../../../human.hpp"
 #include "../../../detail/float_bytes.hpp"
 #include "../../../detail/int_bytes.hpp"
+#include "../action_sequence.hpp"
 
 #include <cmath>
 #include <cstdint>
@@ -126,6 +127,48 @@ read_human_map(Iterator &it, Iterator end)
 	return human_map;
 }
 
+template<typename Iterator, typename Action>
+inline void read_frame(Iterator &it, Iterator end, Action &action)
+{
+	action.push_back(read_human_map(it, end));
+}
+
+template<typename Iterator>
+inline void read_frame(Iterator &it, Iterator end,
+	libaction::motion::multi::ActionSequence &action)
+{
+	auto human_map_size = read_int<std::uint32_t>(it, end);
+	if (human_map_size >= max)
+		throw std::runtime_error("too many items");
+
+	action.push_frame();
+
+	// keep the first human of each index, as std::unordered_map::insert does
+	std::size_t frame = action.size() - 1;
+	for (std::uint32_t i = 0; i < human_map_size; i++) {
+		auto index = read_int<std::uint32_t>(it, end);
+		if (index > max)
+			index = max;
+
+		bool keep = !action.frame(frame).contains(index);
+		if (keep)
+			action.push_human(index);
+
+		// read the parts directly into the sequence
+		for (auto part_index: read_body_parts_bitmap(it, end)) {
+			float x = read_float(it, end);
+			float y = read_float(it, end);
+			float score = read_float(it, end);
+
+			if (std::isnan(x) || std::isnan(y) || std::isnan(score))
+				continue;
+
+			if (keep)
+				action.set_part(part_index, x, y, score);
+		}
+	}
+}
+
 }
 }
 }
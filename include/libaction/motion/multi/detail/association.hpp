@@ -0,0 +1,251 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__MULTI__DETAIL__ASSOCIATION_HPP_
+#define LIBACTION__MOTION__MULTI__DETAIL__ASSOCIATION_HPP_
+
+#include "../../../human.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace multi
+{
+namespace detail
+{
+
+/// The track of a human which is not associated with any track.
+constexpr std::size_t no_track = static_cast<std::size_t>(-1);
+
+/// Association of humans into tracks, frame by frame.
+
+/// A human may only be associated with a track whose last pose has its center
+/// within `max_distance`. Tracks are put into a grid of cells as large as
+/// `max_distance`, so each human is only compared with the tracks in the
+/// cells around it. Pairs are then matched greedily, from the one with the
+/// smallest mean distance of body parts. Humans left unmatched start new
+/// tracks, and tracks missing for more than `max_gap` frames end. Humans
+/// without body parts or with a center not finite are not associated. This
+/// class is not thread safe.
+class Association
+{
+public:
+	/// Constructor.
+
+	/// @param[in]  max_distance    The maximum distance between the centers
+	///                         of a human and the last pose of its track. Must
+	///                         be greater than 0.
+	/// @param[in]  max_gap     The maximum number of frames a track may miss
+	///                         without ending.
+	/// @exception              std::runtime_error
+	inline Association(float max_distance, std::size_t max_gap)
+	:
+	max_distance(max_distance), max_gap(max_gap)
+	{
+		if (!(max_distance > 0.0f))
+			throw std::runtime_error("max_distance <= 0");
+	}
+
+	/// The number of tracks started so far.
+	inline std::size_t size() const
+	{
+		return tracks.size();
+	}
+
+	/// Associate the humans of the next frame.
+
+	/// @param[in]  humans      An iterable of libaction::Human found in the
+	///                         frame.
+	/// @return                 The track of each human in order, or
+	///                         no_track for a human not associated.
+	template<typename Humans>
+	inline std::vector<std::size_t> push(const Humans &humans)
+	{
+		// end the tracks missing for too long, releasing their poses
+		std::size_t kept = 0;
+		for (auto track: active) {
+			if (frame - tracks[track].last_frame > max_gap + 1)
+				tracks[track].pose.reset();
+			else
+				active[kept++] = track;
+		}
+		active.resize(kept);
+
+		// put the active tracks into the grid
+		std::unordered_map<std::uint64_t, std::vector<std::size_t>> grid;
+		for (auto track: active)
+			grid[cell_key(cell_of(tracks[track].x), cell_of(tracks[track].y))]
+				.push_back(track);
+
+		// candidate pairs of (distance, human, track)
+		std::vector<std::tuple<float, std::size_t, std::size_t>> pairs;
+		std::vector<const libaction::Human *> pointers;
+
+		for (auto &human: humans) {
+			std::size_t index = pointers.size();
+			pointers.push_back(&human);
+			if (!associable(human))
+				continue;
+
+			auto &geometry = human.geometry();
+			std::int64_t cell_x = cell_of(geometry.mid_x);
+			std::int64_t cell_y = cell_of(geometry.mid_y);
+
+			for (std::int64_t i = cell_x - 1; i <= cell_x + 1; i++) {
+				for (std::int64_t j = cell_y - 1; j <= cell_y + 1; j++) {
+					auto it = grid.find(cell_key(i, j));
+					if (it == grid.end())
+						continue;
+
+					for (auto track: it->second) {
+						auto &last = tracks[track];
+						float dx = geometry.mid_x - last.x;
+						float dy = geometry.mid_y - last.y;
+						if (std::sqrt(dx * dx + dy * dy) > max_distance)
+							continue;
+
+						pairs.push_back(std::make_tuple(
+							distance(*last.pose, human), index, track));
+					}
+				}
+			}
+		}
+
+		std::sort(pairs.begin(), pairs.end());
+
+		std::vector<std::size_t> result(pointers.size(), no_track);
+		std::vector<bool> matched(tracks.size(), false);
+		for (auto &pair: pairs) {
+			std::size_t index = std::get<1>(pair);
+			std::size_t track = std::get<2>(pair);
+			if (result[index] != no_track || matched[track])
+				continue;
+
+			result[index] = track;
+			matched[track] = true;
+		}
+
+		for (std::size_t index = 0; index < pointers.size(); index++) {
+			auto &human = *pointers[index];
+			if (!associable(human))
+				continue;
+
+			if (result[index] == no_track) {
+				result[index] = tracks.size();
+				tracks.push_back(Track{});
+				active.push_back(result[index]);
+			}
+
+			auto &track = tracks[result[index]];
+			track.last_frame = frame;
+			track.pose.reset(new libaction::Human(human));
+			track.x = track.pose->geometry().mid_x;
+			track.y = track.pose->geometry().mid_y;
+		}
+
+		frame++;
+		return result;
+	}
+
+private:
+	struct Track
+	{
+		std::size_t last_frame = 0;
+		// the last pose, released when the track ends
+		std::unique_ptr<libaction::Human> pose{};
+		// the center of the last pose
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	float max_distance;
+	std::size_t max_gap;
+
+	std::vector<Track> tracks{};
+	// tracks which have not ended
+	std::vector<std::size_t> active{};
+	// the next frame
+	std::size_t frame = 0;
+
+	// Whether a human can be put into the grid.
+	static inline bool associable(const libaction::Human &human)
+	{
+		if (human.body_parts().empty())
+			return false;
+
+		auto &geometry = human.geometry();
+		return std::isfinite(geometry.mid_x) && std::isfinite(geometry.mid_y);
+	}
+
+	inline std::int64_t cell_of(float coordinate) const
+	{
+		// Clamped so that the conversion is defined and the neighbors stay
+		// within the key. Cells beyond the bound share the cells on it, where
+		// distances are still checked exactly.
+		constexpr float bound = static_cast<float>(1 << 30);
+
+		float cell = std::floor(coordinate / max_distance);
+		if (!(cell > -bound))
+			cell = -bound;
+		else if (cell > bound)
+			cell = bound;
+
+		return static_cast<std::int64_t>(cell);
+	}
+
+	static inline std::uint64_t cell_key(std::int64_t x, std::int64_t y)
+	{
+		return (static_cast<std::uint64_t>(x) << 32) ^
+			(static_cast<std::uint64_t>(y) & 0xffffffffULL);
+	}
+
+	// The mean distance of body parts found in both humans, or the distance
+	// of their centers if there is no such part.
+	static inline float distance(const libaction::Human &from,
+		const libaction::Human &to)
+	{
+		float sum = 0.0f;
+		std::size_t count = 0;
+
+		for (auto &part: from.body_parts()) {
+			auto it = to.body_parts().find(part.first);
+			if (it == to.body_parts().end())
+				continue;
+
+			float dx = it->second.x() - part.second.x();
+			float dy = it->second.y() - part.second.y();
+			sum += std::sqrt(dx * dx + dy * dy);
+			count++;
+		}
+
+		if (count != 0)
+			return sum / static_cast<float>(count);
+
+		float dx = to.geometry().mid_x - from.geometry().mid_x;
+		float dy = to.geometry().mid_y - from.geometry().mid_y;
+		return std::sqrt(dx * dx + dy * dy);
+	}
+};
+
+}
+}
+}
+}
+
+#endif
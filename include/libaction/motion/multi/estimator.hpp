@@ -0,0 +1,583 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__MULTI__ESTIMATOR_HPP_
+#define LIBACTION__MOTION__MULTI__ESTIMATOR_HPP_
+
+#include "../../body_part.hpp"
+#include "../../detail/worker_pool.hpp"
+#include "../../human.hpp"
+#include "../single/anti_crossing.hpp"
+#include "../single/fuzz.hpp"
+#include "detail/association.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace multi
+{
+
+/// Multi-person motion estimator.
+
+/// Every human found by the still estimator in a frame is associated with a
+/// track across frames (see set_association()). Each track is then processed
+/// as the motion of a single person, with max_lengths, anti crossing and fuzz
+/// estimation as in motion::single::Estimator. Humans are indexed by their
+/// tracks.
+///
+/// Frames are estimated incrementally: a series of frames is pushed one by
+/// one with push(), and the estimation of a frame is finished as soon as the
+/// frames within its context have arrived, so results lag behind by lag()
+/// frames. Only the frames within the context are kept. A track is reported
+/// at a frame if it is found there, or if it is found both before the frame
+/// and within lag() frames after it.
+///
+/// @warning This class is not thread safe, although it contains multithread
+///          features.
+class Estimator
+{
+public:
+	/// Action data of estimated frames.
+	using Action = std::list<std::unordered_map<std::size_t, libaction::Human>>;
+
+	/// Constructor.
+	inline Estimator()
+	{}
+
+	/// Set the parameters of association.
+
+	/// A human may only be associated with a track whose last pose has its
+	/// center within `max_distance`. Pairs of humans and tracks are matched
+	/// greedily by the mean distance of their body parts. Tracks nearby are
+	/// found through a grid of cells as large as `max_distance`, so
+	/// association takes nearly linear time in the number of humans. The
+	/// parameters take effect from the next series.
+	///
+	/// @param[in]  max_distance    The maximum distance between the centers
+	///                         of a human and the last pose of its track, in
+	///                         the coordinates of body parts. Must be greater
+	///                         than 0.
+	/// @param[in]  max_gap     The maximum number of frames a track may miss
+	///                         without ending.
+	/// @exception              std::runtime_error
+	inline void set_association(float max_distance, std::size_t max_gap)
+	{
+		if (!(max_distance > 0.0f))
+			throw std::runtime_error("max_distance <= 0");
+
+		this->max_distance = max_distance;
+		this->max_gap = max_gap;
+	}
+
+	/// The number of frames a result lags behind the last frame pushed.
+
+	/// @param[in]  fuzz_range  See push().
+	/// @param[in]  anti_crossing   See push().
+	/// @return                 The number of frames after a frame required
+	///                         for finishing its estimation.
+	static inline std::size_t lag(std::size_t fuzz_range, bool anti_crossing)
+	{
+		return (fuzz_range != 0 ? fuzz_range - 1 : 0) +
+			(anti_crossing ? 1 : 0);
+	}
+
+	/// The number of frames pushed since the series started.
+	inline std::size_t pushed() const
+	{
+		return frames_first + frames.size();
+	}
+
+	/// The number of frames estimated since the series started.
+	inline std::size_t finished() const
+	{
+		return next;
+	}
+
+	/// Push the next frame of a series.
+
+	/// The parameters must be the same for all frames of a series.
+	///
+	/// @param[in]  image       The next frame, which must conform to the
+	///                         Boost.MultiArray concept.
+	/// @param[in]  fuzz_range  See motion::single::Estimator::estimate().
+	/// @param[in]  max_lengths See motion::single::Estimator::estimate().
+	/// @param[in]  anti_crossing   Whether to enable anti crossing.
+	/// @param[in]  still_estimators    A vector of one or more initialized
+	///                         human pose estimators, whose `estimate` method
+	///                         must accept any image conforming to the
+	///                         Boost.MultiArray concept and return a list of
+	///                         humans. The first one estimates the frame. If
+	///                         `still_estimators` has multiple elements, the
+	///                         same number of worker threads will be used for
+	///                         processing the tracks.
+	/// @return                 Action data of the frames finished by this
+	///                         frame, starting from frame finished() before
+	///                         the call. May be empty.
+	/// @exception              std::runtime_error, or the first exception
+	///                         thrown by an estimator.
+	template<typename StillEstimator, typename Image>
+	inline std::unique_ptr<Action> push(
+		const Image &image,
+		std::size_t fuzz_range,
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths,
+		bool anti_crossing,
+		const std::vector<StillEstimator*> &still_estimators
+	) {
+		if (still_estimators.empty())
+			throw std::runtime_error("still_estimators is empty");
+
+		start(fuzz_range, max_lengths, anti_crossing, still_estimators.size());
+
+		auto humans = (*still_estimators.begin())->estimate(image);
+		return push_humans(std::move(*humans));
+	}
+
+	/// Finish the series.
+
+	/// The remaining frames are estimated, and the series is restarted
+	/// afterwards.
+	///
+	/// @return                 Action data of the remaining frames, starting
+	///                         from frame finished() before the call.
+	/// @exception              std::runtime_error
+	inline std::unique_ptr<Action> flush()
+	{
+		auto action = std::unique_ptr<Action>(new Action());
+
+		if (started) {
+			// the last frame has no frame to its right
+			if (anti_crossing && !frames.empty())
+				process(pushed() - 1);
+
+			while (next < pushed())
+				action->push_back(std::move(*estimate_next()));
+		}
+
+		reset();
+		return action;
+	}
+
+	/// Restart the series without finishing it.
+	inline void reset()
+	{
+		started = false;
+		association.reset();
+		frames.clear();
+		frames_first = 0;
+		next = 0;
+		spans.clear();
+	}
+
+	/// Estimate for all frames from a series of motion images.
+
+	/// Frames are pushed in order as a new series, so the results are the
+	/// same as with push() and flush(). Any series in progress is restarted.
+	///
+	/// @param[in]  length      The total number of frames.
+	/// @param[in]  fuzz_range  See push().
+	/// @param[in]  max_lengths See push().
+	/// @param[in]  anti_crossing   See push().
+	/// @param[in]  still_estimators    A vector of one or more initialized
+	///                         human pose estimators, as in push(). If
+	///                         `still_estimators` has multiple elements, the
+	///                         same number of worker threads will be used for
+	///                         still estimation as well, each bound to the
+	///                         estimator at its index.
+	/// @param[in]  callback    A callback function returning the image frame
+	///                         at `pos`. Each image is only retrieved once, as
+	///                         the last access. See
+	///                         motion::single::Estimator::estimate().
+	/// @warning                `callback` may be called concurrently from
+	///                         different threads if `still_estimators` has
+	///                         more than one element.
+	/// @return                 Action data of all frames, with humans indexed
+	///                         by track from 0.
+	/// @exception              std::runtime_error, or the first exception
+	///                         thrown by an estimator or `callback` on any
+	///                         thread.
+	template<typename StillEstimator, typename ImagePtr>
+	inline std::unique_ptr<Action> estimate_all(
+		std::size_t length,
+		std::size_t fuzz_range,
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths,
+		bool anti_crossing,
+		const std::vector<StillEstimator*> &still_estimators,
+		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+			&callback
+	) {
+		if (length == 0)
+			throw std::runtime_error("length == 0");
+		if (still_estimators.empty())
+			throw std::runtime_error("still_estimators is empty");
+
+		reset();
+		start(fuzz_range, max_lengths, anti_crossing, still_estimators.size());
+
+		auto action = std::unique_ptr<Action>(new Action());
+
+		try {
+			// still estimation of one frame per worker at a time, so that
+			// only the frames within the context are kept
+			std::size_t chunk = still_estimators.size();
+			std::vector<std::list<libaction::Human>> stills(chunk);
+
+			for (std::size_t first = 0; first < length; first += chunk) {
+				std::size_t size = std::min(chunk, length - first);
+
+				for_each(still_estimators.size(), size,
+					[&] (std::size_t worker, std::size_t i) {
+						auto image = callback(first + i, true);
+						if (!image)
+							throw std::runtime_error(
+								"image callback returned null");
+						stills[i] = std::move(*still_estimators[worker]
+							->estimate(*image));
+					});
+
+				for (std::size_t i = 0; i < size; i++)
+					action->splice(action->end(),
+						*push_humans(std::move(stills[i])));
+			}
+
+			action->splice(action->end(), *flush());
+		} catch (...) {
+			reset();
+			throw;
+		}
+
+		return action;
+	}
+
+private:
+	float max_distance = 0.1f;
+	std::size_t max_gap = 3;
+
+	// workers for multithread estimation, one per still estimator
+	std::unique_ptr<libaction::detail::WorkerPool> workers{};
+
+	// parameters of the series in progress, if started
+	bool started = false;
+	std::size_t fuzz_range = 0;
+	std::vector<std::tuple<
+		libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+		float>> max_lengths{};
+	bool anti_crossing = false;
+	std::size_t threads = 1;
+
+	std::unique_ptr<detail::Association> association{};
+
+	// Humans of a frame.
+	struct Frame
+	{
+		// humans found by the still estimator
+		std::list<libaction::Human> humans{};
+		// the human of each track found in the frame
+		std::unordered_map<std::size_t, const libaction::Human *> poses{};
+		// the poses after anti crossing and max_lengths, filled once the
+		// frames around are pushed
+		std::unordered_map<std::size_t, std::unique_ptr<libaction::Human>>
+			processed{};
+	};
+
+	// frames from frames_first, within the context of the frames not
+	// finished yet
+	std::deque<Frame> frames{};
+	std::size_t frames_first = 0;
+
+	// the next frame to estimate
+	std::size_t next = 0;
+
+	// The frames of a track from its first appearance to its last so far.
+	struct Span
+	{
+		std::size_t first;
+		std::size_t last;
+	};
+
+	// spans of the tracks which may be reported from the next frame
+	std::unordered_map<std::size_t, Span> spans{};
+
+	// Start a series with the parameters, or check that they are the same as
+	// those of the series in progress.
+	inline void start(
+		std::size_t fuzz_range,
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths,
+		bool anti_crossing,
+		std::size_t threads)
+	{
+		if (started) {
+			if (fuzz_range != this->fuzz_range ||
+					max_lengths != this->max_lengths ||
+					anti_crossing != this->anti_crossing)
+				throw std::runtime_error("parameters changed within a series");
+			this->threads = threads;
+			return;
+		}
+
+		started = true;
+		this->fuzz_range = fuzz_range;
+		this->max_lengths = max_lengths;
+		this->anti_crossing = anti_crossing;
+		this->threads = threads;
+		association = std::unique_ptr<detail::Association>(
+			new detail::Association(max_distance, max_gap));
+	}
+
+	// Push the humans found in the next frame of the series started.
+	inline std::unique_ptr<Action> push_humans(
+		std::list<libaction::Human> humans)
+	{
+		std::size_t pos = pushed();
+
+		frames.emplace_back();
+		auto &frame = frames.back();
+		frame.humans = std::move(humans);
+
+		auto indices = association->push(frame.humans);
+		auto human = frame.humans.begin();
+		for (auto index: indices) {
+			// humans not associated are dropped
+			if (index != detail::no_track) {
+				frame.poses[index] = &*human;
+
+				auto it = spans.find(index);
+				if (it == spans.end())
+					spans.insert(std::make_pair(index, Span{ pos, pos }));
+				else
+					it->second.last = pos;
+			}
+			human++;
+		}
+
+		// anti crossing needs the frame to the right
+		if (!anti_crossing)
+			process(pos);
+		else if (pos > 0)
+			process(pos - 1);
+
+		auto action = std::unique_ptr<Action>(new Action());
+		while (next + lag(fuzz_range, anti_crossing) < pushed())
+			action->push_back(std::move(*estimate_next()));
+
+		return action;
+	}
+
+	// The frame at pos, or nullptr if it is not kept.
+	inline const Frame *frame_at(std::size_t pos) const
+	{
+		if (pos < frames_first || pos - frames_first >= frames.size())
+			return nullptr;
+		return &frames[pos - frames_first];
+	}
+
+	// The human of a track in the frame at pos, or nullptr if not found.
+	inline const libaction::Human *pose(std::size_t pos,
+		std::size_t track) const
+	{
+		auto frame = frame_at(pos);
+		if (!frame)
+			return nullptr;
+
+		auto it = frame->poses.find(track);
+		if (it == frame->poses.end())
+			return nullptr;
+		return it->second;
+	}
+
+	// The processed human of a track in the frame at pos, or nullptr if not
+	// found.
+	inline const libaction::Human *processed_pose(std::size_t pos,
+		std::size_t track) const
+	{
+		auto frame = frame_at(pos);
+		if (!frame)
+			return nullptr;
+
+		auto it = frame->processed.find(track);
+		if (it == frame->processed.end())
+			return nullptr;
+		return it->second.get();
+	}
+
+	// Apply anti crossing and max_lengths to the humans in the frame at pos.
+	inline void process(std::size_t pos)
+	{
+		auto &frame = frames[pos - frames_first];
+
+		for (auto &track_pose: frame.poses) {
+			std::unique_ptr<libaction::Human> human;
+
+			if (anti_crossing) {
+				human = libaction::motion::single::anti_crossing
+					::anti_crossing(*track_pose.second,
+						pos > 0 ? pose(pos - 1, track_pose.first) : nullptr,
+						pose(pos + 1, track_pose.first));
+			} else {
+				human = std::unique_ptr<libaction::Human>(
+					new libaction::Human(*track_pose.second));
+			}
+
+			apply_max_lengths(*human, max_lengths);
+			frame.processed[track_pose.first] = std::move(human);
+		}
+	}
+
+	// Estimate the next frame. The frames within its context must have been
+	// pushed and processed, unless the series is being flushed.
+	inline std::unique_ptr<std::unordered_map<std::size_t, libaction::Human>>
+	estimate_next()
+	{
+		std::size_t pos = next;
+		std::size_t length = pushed();
+
+		std::vector<std::size_t> tracks;
+		for (auto &span: spans) {
+			if (span.second.first <= pos && pos <= span.second.last)
+				tracks.push_back(span.first);
+		}
+
+		// fuzz estimation of each track
+		std::vector<std::unique_ptr<libaction::Human>> results(tracks.size());
+		for_each(threads, tracks.size(),
+			[&] (std::size_t, std::size_t i) {
+				std::size_t track = tracks[i];
+
+				auto fuzz_cb = [this, pos, length, track]
+					(std::size_t offset, bool left)
+						-> std::pair<bool, const libaction::Human *>
+				{
+					std::size_t real_pos;
+					if (left) {
+						if (offset > pos)
+							return std::make_pair(false, nullptr);
+						real_pos = pos - offset;
+					} else {
+						if (offset >= length - pos)
+							return std::make_pair(false, nullptr);
+						real_pos = pos + offset;
+					}
+
+					return std::make_pair(true,
+						processed_pose(real_pos, track));
+				};
+
+				results[i] = libaction::motion::single::fuzz::fuzz(
+					fuzz_range, fuzz_cb);
+			});
+
+		auto humans = std::unique_ptr<
+			std::unordered_map<std::size_t, libaction::Human>>(
+				new std::unordered_map<std::size_t, libaction::Human>());
+		for (std::size_t i = 0; i < tracks.size(); i++) {
+			if (results[i])
+				humans->insert(std::make_pair(tracks[i],
+					std::move(*results[i])));
+		}
+
+		next++;
+
+		// drop the tracks not reported from the next frame, unless found
+		// again later
+		for (auto it = spans.begin(); it != spans.end(); ) {
+			if (it->second.last < next)
+				it = spans.erase(it);
+			else
+				it++;
+		}
+
+		// drop frames out of the context of the remaining frames
+		while (!frames.empty() &&
+				frames_first + lag(fuzz_range, anti_crossing) < next) {
+			frames.pop_front();
+			frames_first++;
+		}
+
+		return humans;
+	}
+
+	// Run `job` for every index in [0, size), on `threads` workers if more
+	// than one.
+	inline void for_each(std::size_t threads, std::size_t size,
+		const std::function<void(std::size_t worker, std::size_t index)> &job)
+	{
+		if (threads <= 1) {
+			for (std::size_t index = 0; index < size; index++)
+				job(0, index);
+			return;
+		}
+
+		if (!workers || workers->size() != threads) {
+			workers.reset();
+			workers = std::unique_ptr<libaction::detail::WorkerPool>(
+				new libaction::detail::WorkerPool(threads));
+		}
+
+		std::atomic<std::size_t> counter{ 0 };
+		std::atomic<bool> failed{ false };
+		workers->start([&] (std::size_t worker) {
+			std::size_t index;
+			while (!failed && (index = counter++) < size) {
+				try {
+					job(worker, index);
+				} catch (...) {
+					failed = true;
+					throw;
+				}
+			}
+		});
+		workers->wait();
+	}
+
+	// Remove the "to" part of each pair of body parts farther than allowed.
+	static inline void apply_max_lengths(libaction::Human &human,
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths)
+	{
+		for (auto &arg: max_lengths) {
+			auto from = human.body_parts().find(std::get<0>(arg));
+			if (from == human.body_parts().end())
+				continue;
+			auto to = human.body_parts().find(std::get<1>(arg));
+			if (to == human.body_parts().end())
+				continue;
+
+			if (std::sqrt((from->second.x() - to->second.x()) * (from->second.x() - to->second.x())
+					+ (from->second.y() - to->second.y()) * (from->second.y() - to->second.y()))
+					> std::get<2>(arg)) {
+				human.body_parts().erase(to);
+			}
+		}
+	}
+};
+
+}
+}
+}
+
+#endif
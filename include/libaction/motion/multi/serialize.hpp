@@ -12,6 +12,7 @@
 #include "../../human.hpp"
 #include "../../detail/float_bytes.hpp"
 #include "../../detail/int_bytes.hpp"
+#include "action_sequence.hpp"
 #include "serialize/detail.hpp"
 
 #include <cmath>
@@ -66,6 +67,38 @@ serialize(const Action &action, bool magic = true)
 	return data;
 }
 
+/// Serialize action data into bytes.
+
+/// @param[in]  action      Action data.
+/// @param[in]  magic       Whether the magic number should be included.
+/// @return                 Serialized bytes.
+/// @exception              std::runtime_error
+inline std::unique_ptr<std::vector<std::uint8_t>>
+serialize(const libaction::motion::multi::ActionSequence &action,
+	bool magic = true)
+{
+	auto data = std::unique_ptr<std::vector<std::uint8_t>>(
+		new std::vector<std::uint8_t>());
+
+	if (magic) {
+		data->push_back(static_cast<std::uint8_t>('A'));
+		data->push_back(static_cast<std::uint8_t>('C'));
+		data->push_back(static_cast<std::uint8_t>('T'));
+		data->push_back(0);
+	}
+
+	if (action.size() >= detail::max)
+		throw std::runtime_error("too many items");
+
+	detail::write_int(static_cast<std::uint32_t>(action.size()), *data);
+
+	for (std::size_t i = 0; i < action.size(); i++) {
+		detail::write_frame(action.frame(i), *data);
+	}
+
+	return data;
+}
+
 }
 }
 }
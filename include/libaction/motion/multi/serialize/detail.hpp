@@ -12,6 +12,7 @@
 #include "../../../human.hpp"
 #include "../../../detail/float_bytes.hpp"
 #include "../../../detail/int_bytes.hpp"
+#include "../action_sequence.hpp"
 
 #include <cmath>
 #include <cstdint>
@@ -102,6 +103,48 @@ inline void write_human_map(const HumanMap &human_map,
 	}
 }
 
+inline void write_frame(const libaction::motion::multi::ActionSequence::Frame &frame,
+	std::vector<std::uint8_t> &output)
+{
+	using libaction::motion::multi::ActionSequence;
+
+	static_assert(ActionSequence::parts_size < 32,
+		"ActionSequence::parts_size < 32");
+
+	if (frame.size() >= max)
+		throw std::runtime_error("too many items");
+
+	write_int(static_cast<std::uint32_t>(frame.size()), output);
+
+	for (std::size_t i = 0; i < frame.size(); i++) {
+		std::uint32_t index = frame.index(i);
+		if (index > max)
+			index = max;
+		write_int(index, output);
+
+		// the stored bitmap has bit `j` for part `j`, while the serialized
+		// bitmap counts from the most significant bit
+		std::uint32_t mask = frame.mask(i);
+		std::uint32_t bitmap = 0;
+		for (std::size_t j = 0; j < ActionSequence::parts_size; j++) {
+			if ((mask & (1UL << j)) != 0)
+				bitmap |= (1UL << (31 - j));
+		}
+		write_int(bitmap, output);
+
+		for (std::size_t j = 0; j < ActionSequence::parts_size; j++) {
+			if ((mask & (1UL << j)) == 0)
+				continue;
+
+			auto part = frame.part(i,
+				static_cast<libaction::BodyPart::PartIndex>(j));
+			write_float(part.x(), output);
+			write_float(part.y(), output);
+			write_float(part.score(), output);
+		}
+	}
+}
+
 }
 }
 }
@@ -10,6 +10,7 @@
 
 #include "../../body_part.hpp"
 #include "../../human.hpp"
+#include "../../skeleton.hpp"
 #include "anti_crossing/detail.hpp"
 
 #include <cmath>
@@ -26,6 +27,8 @@ namespace anti_crossing
 
 /// Process an estimation of a single person to reduce crossing results.
 
+/// @tparam     Skeleton    The skeleton whose left and right body parts are
+///                         checked for crossing.
 /// @param[in]  target      The result from a previous estimation. Only a single
 ///                         human (with at least one body part) is supported.
 /// @param[in]  left        The result of the estimation on the frame to the
@@ -35,58 +38,39 @@ namespace anti_crossing
 ///                         right of the target. It must contain the same person
 ///                         as found in target.
 /// @return                 The processed estimation.
+template<typename Skeleton = libaction::skeleton::Coco18>
 inline std::unique_ptr<libaction::Human> anti_crossing(
 	const libaction::Human &target,
 	const libaction::Human *left,
 	const libaction::Human *right
 ) {
-	using id = libaction::BodyPart::PartIndex;
-
 	auto result = std::unique_ptr<libaction::Human>(new libaction::Human(
 		target));
 
 	float size = 0.0f;
 
 	if (!target.body_parts().empty()) {
-		float x1 = target.body_parts().begin()->second.x();
-		float x2 = x1;
-		float y1 = target.body_parts().begin()->second.y();
-		float y2 = y1;
-
-		for (auto &part: target.body_parts()) {
-			x1 = std::min(x1, part.second.x());
-			x2 = std::max(x2, part.second.x());
-			y1 = std::min(y1, part.second.y());
-			y2 = std::max(y2, part.second.y());
-		}
-
-		size = std::max(size, std::max(x2 - x1, y2 - y1));
+		auto &geometry = target.geometry();
+		size = std::max(size, std::max(geometry.x2 - geometry.x1,
+			geometry.y2 - geometry.y1));
 	}
 
 	// notice the confusion between left frame / right frame and
 	// left body part / right body part
 
-	for (auto current: {
-		std::tuple<id, id>{ id::eye_l, id::eye_r },
-		std::tuple<id, id>{ id::ear_l, id::ear_r },
-		std::tuple<id, id>{ id::shoulder_l, id::shoulder_r },
-		std::tuple<id, id>{ id::elbow_l, id::elbow_r },
-		std::tuple<id, id>{ id::wrist_l, id::wrist_r },
-		std::tuple<id, id>{ id::hip_l, id::hip_r },
-		std::tuple<id, id>{ id::knee_l, id::knee_r },
-		std::tuple<id, id>{ id::ankle_l, id::ankle_r } })
+	for (auto &current: Skeleton::mirrors)
 	{
 		bool left_cross = false, right_cross = false;
 
-		auto target_0 = target.body_parts().find(std::get<0>(current));
-		auto target_1 = target.body_parts().find(std::get<1>(current));
+		auto target_0 = target.body_parts().find(current.first);
+		auto target_1 = target.body_parts().find(current.second);
 
 		for (auto side: { left, right }) {
 			if (!side)
 				continue;
 
-			auto side_0 = side->body_parts().find(std::get<0>(current));
-			auto side_1 = side->body_parts().find(std::get<1>(current));
+			auto side_0 = side->body_parts().find(current.first);
+			auto side_1 = side->body_parts().find(current.second);
 
 			if (target_0 != target.body_parts().end() &&
 					target_1 != target.body_parts().end()) {
@@ -189,11 +173,11 @@ inline std::unique_ptr<libaction::Human> anti_crossing(
 
 		if (left_cross) {
 			// remove left
-			result->body_parts().erase(std::get<0>(current));
+			result->body_parts().erase(current.first);
 		}
 		if (right_cross) {
 			// remove right
-			result->body_parts().erase(std::get<1>(current));
+			result->body_parts().erase(current.second);
 		}
 	}
 
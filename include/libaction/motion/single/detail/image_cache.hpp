@@ -0,0 +1,198 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__SINGLE__DETAIL__IMAGE_CACHE_HPP_
+#define LIBACTION__MOTION__SINGLE__DETAIL__IMAGE_CACHE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+namespace libaction
+{
+namespace motion
+{
+namespace single
+{
+namespace detail
+{
+
+/// Images indexed by frame, within a budget of bytes.
+
+/// Room for an image is reserved before the image is fetched, based on the
+/// size of the last image stored, so that the image can be fetched as the
+/// last access if it is going to be cached. Until a budget in bytes is set,
+/// the default budget is a number of images, sized from the first image
+/// stored. Images of any pointer type can be stored, but an image is only
+/// found with the type it is stored with. This class is not thread safe.
+class ImageCache
+{
+public:
+	/// Set the budget in bytes, replacing the default budget. Images already
+	/// stored are kept.
+	inline void set_budget(std::size_t bytes)
+	{
+		budget = bytes;
+		automatic = false;
+	}
+
+	/// Set the default budget in images, which is used until set_budget() is
+	/// called. Images already stored are kept.
+	inline void set_default_images(std::size_t images)
+	{
+		default_images = images;
+	}
+
+	/// Reserve room for the image at `pos`.
+
+	/// @return                 Whether room is reserved. If true, either
+	///                         insert() or cancel() must follow.
+	inline bool reserve(std::size_t pos)
+	{
+		if (entries.find(pos) != entries.end())
+			return false;
+
+		if (automatic) {
+			// the size of an image is unknown until the first one is stored
+			if (entries.size() >= default_images)
+				return false;
+			if (first_bytes != 0 &&
+					used + last_bytes > default_images * first_bytes)
+				return false;
+		} else {
+			if (budget == 0 || used + last_bytes > budget)
+				return false;
+		}
+
+		entries[pos] = Entry{ nullptr, nullptr, last_bytes };
+		used += last_bytes;
+		return true;
+	}
+
+	/// Cancel the reservation at `pos`.
+	inline void cancel(std::size_t pos)
+	{
+		erase(pos);
+	}
+
+	/// Store the image at `pos`, which must be reserved.
+
+	/// @return                 The stored image.
+	template<typename ImagePtr>
+	inline std::shared_ptr<const ImagePtr> insert(std::size_t pos,
+		ImagePtr image)
+	{
+		std::shared_ptr<const ImagePtr> stored =
+			std::make_shared<ImagePtr>(std::move(image));
+		std::size_t bytes = size_of(**stored);
+
+		auto &entry = entries.at(pos);
+		used = used - entry.bytes + bytes;
+		entry = Entry{ stored, &typeid(ImagePtr), bytes };
+		last_bytes = bytes;
+		if (first_bytes == 0)
+			first_bytes = bytes;
+
+		return stored;
+	}
+
+	/// Get the image at `pos`.
+
+	/// @return                 The image, or `nullptr` if not found.
+	template<typename ImagePtr>
+	inline std::shared_ptr<const ImagePtr> get(std::size_t pos) const
+	{
+		auto it = entries.find(pos);
+		if (it == entries.end() || !it->second.image ||
+				*it->second.type != typeid(ImagePtr))
+			return nullptr;
+
+		return std::static_pointer_cast<const ImagePtr>(it->second.image);
+	}
+
+	/// Get and remove the image at `pos`.
+
+	/// @return                 The image, or `nullptr` if not found.
+	template<typename ImagePtr>
+	inline std::shared_ptr<const ImagePtr> take(std::size_t pos)
+	{
+		auto image = get<ImagePtr>(pos);
+		if (image)
+			erase(pos);
+		return image;
+	}
+
+	/// Remove the image at `pos`.
+
+	/// @return                 Whether an image or a reservation is removed.
+	inline bool erase(std::size_t pos)
+	{
+		auto it = entries.find(pos);
+		if (it == entries.end())
+			return false;
+
+		used -= it->second.bytes;
+		entries.erase(it);
+		return true;
+	}
+
+	/// Remove all images outside of [first, first + size).
+	inline void retain(std::size_t first, std::size_t size)
+	{
+		for (auto it = entries.begin(); it != entries.end(); ) {
+			if (it->first >= first && it->first - first < size) {
+				it++;
+			} else {
+				used -= it->second.bytes;
+				it = entries.erase(it);
+			}
+		}
+	}
+
+	/// Remove all images, and forget the size of images.
+	inline void clear()
+	{
+		entries.clear();
+		used = 0;
+		last_bytes = 0;
+		first_bytes = 0;
+	}
+
+	/// The number of bytes of an image.
+	template<typename Image>
+	static inline std::size_t size_of(const Image &image)
+	{
+		return image.num_elements() * sizeof(typename Image::element);
+	}
+
+private:
+	struct Entry
+	{
+		// nullptr if reserved only
+		std::shared_ptr<const void> image;
+		const std::type_info *type;
+		std::size_t bytes;
+	};
+
+	std::unordered_map<std::size_t, Entry> entries{};
+	std::size_t budget = 0;
+	// whether the default budget is used
+	bool automatic = true;
+	std::size_t default_images = 0;
+	std::size_t used = 0;
+	std::size_t last_bytes = 0;
+	std::size_t first_bytes = 0;
+};
+
+}
+}
+}
+}
+
+#endif
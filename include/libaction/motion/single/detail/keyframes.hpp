@@ -0,0 +1,165 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__SINGLE__DETAIL__KEYFRAMES_HPP_
+#define LIBACTION__MOTION__SINGLE__DETAIL__KEYFRAMES_HPP_
+
+#include "../../../human.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace single
+{
+namespace detail
+{
+
+/// Keyframes of a series, decided in order from frame 0.
+
+/// Frame 0 is a keyframe. The stride to the next keyframe is decided from the
+/// pose of the last keyframe, so that body parts are expected to move by at
+/// most `max_motion` between keyframes at the velocity observed between the
+/// last two keyframes. The stride is 1 as long as no velocity is observed,
+/// e.g. when no human is found at either keyframe.
+class KeyframeSchedule
+{
+public:
+	/// Set the parameters. The schedule restarts if they change.
+
+	/// @param[in]  max_stride  The maximum stride between keyframes. Every
+	///                         frame is a keyframe if `max_stride` is not
+	///                         greater than 1.
+	/// @param[in]  max_motion  The expected motion of a body part between
+	///                         keyframes.
+	/// @return                 Whether the parameters change.
+	inline bool set_parameters(std::size_t max_stride, float max_motion)
+	{
+		if (max_stride < 1)
+			max_stride = 1;
+		if (max_stride == this->max_stride && max_motion == this->max_motion)
+			return false;
+
+		this->max_stride = max_stride;
+		this->max_motion = max_motion;
+		clear();
+		return true;
+	}
+
+	/// Whether frames other than keyframes exist.
+	inline bool enabled() const
+	{
+		return max_stride > 1;
+	}
+
+	/// The number of frames decided, from frame 0.
+	inline std::size_t decided() const
+	{
+		return keyframes.size();
+	}
+
+	/// Whether `pos`, which must be decided, is a keyframe.
+	inline bool is_keyframe(std::size_t pos) const
+	{
+		return keyframes[pos];
+	}
+
+	/// The last keyframe decided, which is the last frame decided.
+	inline std::size_t last() const
+	{
+		return keyframes.size() - 1;
+	}
+
+	/// Decide the frames up to the next keyframe.
+
+	/// @param[in]  pose        The pose at last(), or `nullptr` if no human
+	///                         is found.
+	inline void advance(const libaction::Human *pose)
+	{
+		std::size_t last = this->last();
+		std::size_t stride = 1;
+
+		if (pose && previous_pose) {
+			float distance = mean_distance(*previous_pose, *pose);
+			if (distance >= 0.0f) {
+				float velocity = distance /
+					static_cast<float>(last - previous);
+				if (velocity * static_cast<float>(max_stride) <= max_motion) {
+					stride = max_stride;
+				} else {
+					stride = static_cast<std::size_t>(max_motion / velocity);
+					if (stride < 1)
+						stride = 1;
+				}
+			}
+		}
+
+		keyframes.resize(last + stride, false);
+		keyframes.push_back(true);
+
+		previous = last;
+		if (pose)
+			previous_pose.reset(new libaction::Human(*pose));
+		else
+			previous_pose.reset();
+	}
+
+	/// Restart the schedule with the same parameters.
+	inline void clear()
+	{
+		keyframes.assign(1, true);
+		previous = 0;
+		previous_pose.reset();
+	}
+
+private:
+	std::size_t max_stride = 1;
+	float max_motion = 0.0f;
+
+	// whether each frame decided is a keyframe
+	std::vector<bool> keyframes{ true };
+
+	// the keyframe before last(), and its pose if a human is found
+	std::size_t previous = 0;
+	std::unique_ptr<libaction::Human> previous_pose{};
+
+	// The mean distance of body parts found in both poses, or a negative
+	// value if there is no such part.
+	static inline float mean_distance(const libaction::Human &from,
+		const libaction::Human &to)
+	{
+		float sum = 0.0f;
+		std::size_t count = 0;
+
+		for (auto &part: from.body_parts()) {
+			auto it = to.body_parts().find(part.first);
+			if (it == to.body_parts().end())
+				continue;
+
+			float dx = it->second.x() - part.second.x();
+			float dy = it->second.y() - part.second.y();
+			sum += std::sqrt(dx * dx + dy * dy);
+			count++;
+		}
+
+		if (count == 0)
+			return -1.0f;
+		return sum / static_cast<float>(count);
+	}
+};
+
+}
+}
+}
+}
+
+#endif
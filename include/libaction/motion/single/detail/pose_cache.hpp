@@ -0,0 +1,212 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__SINGLE__DETAIL__POSE_CACHE_HPP_
+#define LIBACTION__MOTION__SINGLE__DETAIL__POSE_CACHE_HPP_
+
+#include "../../../human.hpp"
+#include "../../../detail/packed_human.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace single
+{
+namespace detail
+{
+
+/// Storage of a pose in BasicPoseCache.
+template<bool Packed>
+struct PoseSlot;
+
+/// A pose stored as it is.
+template<>
+struct PoseSlot<false>
+{
+	using pose_ptr = std::unique_ptr<const libaction::Human,
+		std::function<void(const libaction::Human *)>>;
+
+	std::unique_ptr<libaction::Human> human{};
+
+	inline void store(std::unique_ptr<libaction::Human> human)
+	{
+		// borrowed poses may be read from several threads, so the geometry
+		// cache is filled before sharing
+		if (human)
+			human->geometry();
+		this->human = std::move(human);
+	}
+
+	inline pose_ptr get() const
+	{
+		if (!human)
+			return pose_ptr();
+
+		return pose_ptr(human.get(), [] (const libaction::Human *) {});
+	}
+
+	inline const libaction::Human *borrow() const
+	{
+		return human.get();
+	}
+};
+
+/// A pose stored as libaction::detail::PackedHuman.
+template<>
+struct PoseSlot<true>
+{
+	using pose_ptr = PoseSlot<false>::pose_ptr;
+
+	// whether a human is found
+	bool found = false;
+	libaction::detail::PackedHuman human{};
+
+	inline void store(std::unique_ptr<libaction::Human> human)
+	{
+		found = static_cast<bool>(human);
+		if (human)
+			this->human = libaction::detail::PackedHuman(*human);
+	}
+
+	inline pose_ptr get() const
+	{
+		if (!found)
+			return pose_ptr();
+
+		return pose_ptr(human.unpack().release(),
+			[] (const libaction::Human *ptr) { delete ptr; });
+	}
+};
+
+/// Still poses indexed by frame, within a sliding window of frames.
+
+/// Poses are stored in a ring buffer indexed by frame. Moving the window
+/// evicts poses outside of it without touching the others, so that a frame
+/// leaving the window never comes back along with stale data tied to it.
+///
+/// If `Packed` is true, poses are stored as libaction::detail::PackedHuman
+/// and decoded on access. Otherwise they are stored as they are and borrowed
+/// on access.
+///
+/// @tparam     Packed      Whether poses are packed.
+template<bool Packed>
+class BasicPoseCache
+{
+public:
+	/// A pose obtained from the cache, either borrowed or owned.
+	using pose_ptr = typename PoseSlot<Packed>::pose_ptr;
+
+	/// Move the window to [first, first + capacity). All poses are dropped if
+	/// the capacity changes, otherwise poses outside of the window.
+	inline void set_window(std::size_t first, std::size_t capacity)
+	{
+		if (capacity != slots.size())
+			slots = std::vector<Slot>(capacity);
+		window_first = first;
+
+		for (auto &slot: slots) {
+			if (slot.filled && !in_window(slot.pos))
+				slot = Slot();
+		}
+	}
+
+	/// Whether `pos` is within the window.
+	inline bool in_window(std::size_t pos) const
+	{
+		return pos >= window_first && pos - window_first < slots.size();
+	}
+
+	inline bool contains(std::size_t pos) const
+	{
+		if (!in_window(pos))
+			return false;
+
+		auto &slot = slots[pos % slots.size()];
+		return slot.filled && slot.pos == pos;
+	}
+
+	/// Insert a pose, or `nullptr` if no human is found at `pos`, which must
+	/// be within the window. Nothing is done if `pos` already exists.
+	inline void insert(std::size_t pos, std::unique_ptr<libaction::Human> human)
+	{
+		if (!in_window(pos))
+			throw std::runtime_error("pos is out of the pose window");
+		if (contains(pos))
+			return;
+
+		auto &slot = slots[pos % slots.size()];
+		slot.pos = pos;
+		slot.filled = true;
+		slot.pose.store(std::move(human));
+	}
+
+	/// Get the pose at `pos`, which must exist. The result is `nullptr` if no
+	/// human is found at `pos`. A borrowed pose remains valid until the cache
+	/// is cleared or the pose is evicted.
+	inline pose_ptr get(std::size_t pos) const
+	{
+		if (!contains(pos))
+			throw std::runtime_error("pos is not in the pose cache");
+
+		return slots[pos % slots.size()].pose.get();
+	}
+
+	/// Borrow the pose at `pos`, which must exist, without any allocation.
+	/// Only available if poses are not packed. The result is `nullptr` if no
+	/// human is found at `pos`, and remains valid until the cache is cleared
+	/// or the pose is evicted.
+	inline const libaction::Human *borrow(std::size_t pos) const
+	{
+		if (!contains(pos))
+			throw std::runtime_error("pos is not in the pose cache");
+
+		return slots[pos % slots.size()].pose.borrow();
+	}
+
+	inline void clear()
+	{
+		for (auto &slot: slots)
+			slot = Slot();
+	}
+
+private:
+	struct Slot
+	{
+		std::size_t pos = 0;
+		bool filled = false;
+		PoseSlot<Packed> pose{};
+	};
+
+	std::vector<Slot> slots{};
+	std::size_t window_first = 0;
+};
+
+/// Whether poses are packed by default, which is the case if
+/// LIBACTION_PACKED_POSE_CACHE is defined.
+#ifdef LIBACTION_PACKED_POSE_CACHE
+constexpr bool packed_pose_cache = true;
+#else
+constexpr bool packed_pose_cache = false;
+#endif
+
+/// Poses never packed, which can be borrowed.
+using PlainPoseCache = BasicPoseCache<false>;
+
+}
+}
+}
+}
+
+#endif
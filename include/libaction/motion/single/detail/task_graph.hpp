@@ -0,0 +1,188 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__SINGLE__DETAIL__TASK_GRAPH_HPP_
+#define LIBACTION__MOTION__SINGLE__DETAIL__TASK_GRAPH_HPP_
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace single
+{
+namespace detail
+{
+
+/// Still estimation tasks for multithread estimation.
+
+/// A zoomed task depends on the unzoomed tasks within its zoom range, and an
+/// unzoomed task may depend on the unzoomed tasks it tracks from (see
+/// Estimator::set_tracking()). A task becomes ready when the last of its
+/// dependencies finishes. Ready tasks are taken in
+/// constant time, primary tasks before extra ones. This class is not thread
+/// safe.
+class TaskGraph
+{
+public:
+	/// A task of (pos, zoomed).
+	using Task = std::pair<std::size_t, bool>;
+
+	/// Whether the unzoomed task at `pos` has been added.
+	inline bool contains_unzoomed(std::size_t pos) const
+	{
+		return unzoomed_ids.find(pos) != unzoomed_ids.end();
+	}
+
+	/// Whether the zoomed task at `pos` has been added.
+	inline bool contains_zoomed(std::size_t pos) const
+	{
+		return zoomed_ids.find(pos) != zoomed_ids.end();
+	}
+
+	/// Add an unzoomed task depending on the unzoomed tasks at
+	/// `dependencies`. Positions without an added and unfinished unzoomed
+	/// task are ignored.
+	inline void add_unzoomed(std::size_t pos, bool extra,
+		const std::vector<std::size_t> &dependencies = {})
+	{
+		std::size_t id = add_node(pos, false, extra);
+		unzoomed_ids[pos] = id;
+		add_dependencies(id, dependencies);
+	}
+
+	/// Add a zoomed task depending on the unzoomed tasks at `dependencies`.
+	/// Positions without an added and unfinished unzoomed task are ignored.
+	inline void add_zoomed(std::size_t pos, bool extra,
+		const std::vector<std::size_t> &dependencies)
+	{
+		std::size_t id = add_node(pos, true, extra);
+		zoomed_ids[pos] = id;
+		add_dependencies(id, dependencies);
+	}
+
+	/// Whether all primary tasks have been taken.
+	inline bool empty() const
+	{
+		return primary_left == 0;
+	}
+
+	/// Take a ready task.
+
+	/// @param[out] task        The task taken.
+	/// @return                 Whether a task is taken.
+	inline bool pop(Task &task)
+	{
+		for (auto &queue: ready) {
+			if (queue.empty())
+				continue;
+
+			auto &node = nodes[queue.front()];
+			queue.pop_front();
+
+			if (!node.extra)
+				primary_left--;
+			task = std::make_pair(node.pos, node.zoomed);
+			return true;
+		}
+
+		return false;
+	}
+
+	/// Mark a taken task as finished, making its dependents ready if
+	/// possible.
+	inline void finish(const Task &task)
+	{
+		if (task.second)
+			return;
+
+		auto it = unzoomed_ids.find(task.first);
+		if (it == unzoomed_ids.end())
+			return;
+
+		auto &node = nodes[it->second];
+		node.finished = true;
+
+		for (auto id: node.dependents) {
+			auto &dependent = nodes[id];
+			if (--dependent.dependencies == 0) {
+				// zoomed tasks are the slowest, and tracked tasks are on
+				// the path of the tasks tracking from them, so start them
+				// first
+				ready[dependent.extra ? 1 : 0].push_front(id);
+			}
+		}
+	}
+
+	/// Drop all tasks.
+	inline void clear()
+	{
+		nodes.clear();
+		unzoomed_ids.clear();
+		zoomed_ids.clear();
+		for (auto &queue: ready)
+			queue.clear();
+		primary_left = 0;
+	}
+
+private:
+	struct Node
+	{
+		std::size_t pos;
+		bool zoomed;
+		bool extra;
+		bool finished;
+		// number of unfinished dependencies
+		std::size_t dependencies;
+		std::vector<std::size_t> dependents;
+	};
+
+	std::vector<Node> nodes{};
+	std::unordered_map<std::size_t, std::size_t> unzoomed_ids{}, zoomed_ids{};
+
+	// ready primary tasks and ready extra tasks
+	std::deque<std::size_t> ready[2]{};
+	std::size_t primary_left = 0;
+
+	inline std::size_t add_node(std::size_t pos, bool zoomed, bool extra)
+	{
+		nodes.push_back(Node{ pos, zoomed, extra, false, 0, {} });
+		if (!extra)
+			primary_left++;
+		return nodes.size() - 1;
+	}
+
+	// Make the node at id depend on the unzoomed tasks at dependencies. The
+	// node is ready if there is none.
+	inline void add_dependencies(std::size_t id,
+		const std::vector<std::size_t> &dependencies)
+	{
+		for (auto dependency: dependencies) {
+			auto it = unzoomed_ids.find(dependency);
+			if (it == unzoomed_ids.end() || nodes[it->second].finished)
+				continue;
+
+			nodes[it->second].dependents.push_back(id);
+			nodes[id].dependencies++;
+		}
+
+		if (nodes[id].dependencies == 0)
+			ready[nodes[id].extra ? 1 : 0].push_back(id);
+	}
+};
+
+}
+}
+}
+}
+
+#endif
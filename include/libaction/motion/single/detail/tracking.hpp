@@ -0,0 +1,96 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__SINGLE__DETAIL__TRACKING_HPP_
+#define LIBACTION__MOTION__SINGLE__DETAIL__TRACKING_HPP_
+
+#include "../../../human.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+namespace libaction
+{
+namespace motion
+{
+namespace single
+{
+namespace detail
+{
+
+/// A region of an image, in the coordinates of body parts.
+struct Region
+{
+	float x1;
+	float x2;
+	float y1;
+	float y2;
+};
+
+/// Predict the region of the human at a frame from the frames before it.
+
+/// The bounding box of the last pose is moved by the velocity observed
+/// between the two poses, and enlarged by `margin` times its size on each side
+/// along with the distance moved.
+///
+/// @param[in]  pos         The frame to predict for.
+/// @param[in]  last_pos    The frame of `last`, which must be before `pos`.
+/// @param[in]  last        The last pose, or `nullptr` if no human is found.
+/// @param[in]  previous_pos    The frame of `previous`, which must be before
+///                         `last_pos`.
+/// @param[in]  previous    The pose before `last`, or `nullptr` if unknown.
+/// @param[in]  margin      The margin around the bounding box.
+/// @param[out] region      The region predicted.
+/// @return                 Whether a region is predicted, which requires a
+///                         human at `last`.
+inline bool predict_region(std::size_t pos,
+	std::size_t last_pos, const libaction::Human *last,
+	std::size_t previous_pos, const libaction::Human *previous,
+	float margin, Region &region)
+{
+	if (!last || last->body_parts().empty())
+		return false;
+
+	auto &geometry = last->geometry();
+
+	float dx = 0.0f, dy = 0.0f;
+	if (previous && !previous->body_parts().empty()) {
+		auto &previous_geometry = previous->geometry();
+		float frames = static_cast<float>(pos - last_pos) /
+			static_cast<float>(last_pos - previous_pos);
+		dx = (geometry.mid_x - previous_geometry.mid_x) * frames;
+		dy = (geometry.mid_y - previous_geometry.mid_y) * frames;
+	}
+
+	float margin_x = (geometry.x2 - geometry.x1) * margin + std::fabs(dx);
+	float margin_y = (geometry.y2 - geometry.y1) * margin + std::fabs(dy);
+
+	region = Region{
+		geometry.x1 + dx - margin_x, geometry.x2 + dx + margin_x,
+		geometry.y1 + dy - margin_y, geometry.y2 + dy + margin_y
+	};
+	return true;
+}
+
+/// The mean score of the body parts of a human, or 0 if there is none.
+inline float mean_score(const libaction::Human &human)
+{
+	if (human.body_parts().empty())
+		return 0.0f;
+
+	float score = 0.0f;
+	for (auto &part: human.body_parts())
+		score += part.second.score();
+	return score / static_cast<float>(human.body_parts().size());
+}
+
+}
+}
+}
+}
+
+#endif
@@ -9,25 +9,34 @@
 #define LIBACTION__MOTION__SINGLE__ESTIMATOR_HPP_
 
 #include "../../body_part.hpp"
+#include "../../detail/image.hpp"
+#include "../../detail/worker_pool.hpp"
 #include "../../human.hpp"
 #include "../../still/single/zoom.hpp"
 #include "anti_crossing.hpp"
 #include "fuzz.hpp"
+#include "detail/image_cache.hpp"
+#include "detail/keyframes.hpp"
+#include "detail/pose_cache.hpp"
+#include "detail/task_graph.hpp"
+#include "detail/tracking.hpp"
 
 #include <boost/multi_array.hpp>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <mutex>
-#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -40,13 +49,24 @@ namespace single
 
 /// Single-person motion estimator.
 
+/// Still poses are cached between calls, within a window of frames around the
+/// current frame whose size only depends on the parameters. If `PackedPoses`
+/// is true, they are cached in a compact form with 16-bit coordinates and
+/// 8-bit scores, which saves memory at the cost of some precision.
+///
+/// @tparam     PackedPoses Whether to pack cached still poses. True by default
+///                         if LIBACTION_PACKED_POSE_CACHE is defined. Since
+///                         each setting is a distinct type, translation units
+///                         built with and without the macro do not share
+///                         definitions.
 /// @warning This class is not thread safe, although it contains multithread
 ///          features.
-class Estimator
+template<bool PackedPoses = detail::packed_pose_cache>
+class BasicEstimator
 {
 public:
 	/// Constructor.
-	inline Estimator()
+	inline BasicEstimator()
 	{}
 
 	/// Estimate for a single frame from a series of motion images.
@@ -72,7 +92,10 @@ public:
 	///                         must accept any image conforming to the
 	///                         Boost.MultiArray concept. If `still_estimators`
 	///                         has multiple elements, the same number of
-	///                         threads will be created.
+	///                         worker threads will be used, each bound to the
+	///                         estimator at its index. The threads are kept
+	///                         between calls and recreated only when the
+	///                         number of estimators changes.
 	/// @param[in]  zoom_still_estimators   Estimators for zoom estimation. Can
 	///                         be identical to `still_estimators`. Must have
 	///                         the same number of elements as
@@ -82,15 +105,23 @@ public:
 	///                         the image frame at `pos`. `last_image_access`
 	///                         indicates whether the image at `pos` is no
 	///                         longer needed (if no error occurs). The same
-	///                         image at `pos` may be retrieved multiple times.
+	///                         image at `pos` may be retrieved multiple times,
+	///                         e.g. once more for zoom reestimation if the
+	///                         image cache has no room for it (see
+	///                         set_image_cache()).
 	///                         The callback should return a valid pointer to
 	///                         the image, which must conform to the
-	///                         Boost.MultiArray concept.
+	///                         Boost.MultiArray concept. The pointer is
+	///                         destroyed as soon as the image is no longer
+	///                         needed, so the image can be recycled with
+	///                         libaction::ImagePool.
 	/// @warning                `callback` may be called concurrently from
 	///                         different threads if `still_estimators` has
-	///                         more than one element.
+	///                         more than one element. See set_prefetch().
 	/// @return                 A map of indexed humans. Index starts from 0.
-	/// @exception              std::runtime_error
+	/// @exception              std::runtime_error, or the first exception
+	///                         thrown by an estimator or `callback` on any
+	///                         thread. See also cancel().
 	/// @sa                     anti_crossing, fuzz, still::single::Estimator
 	///                         and still::single::zoom
 	template<typename StillEstimator, typename ZoomStillEstimator,
@@ -120,20 +151,39 @@ public:
 		if (still_estimators.size() != zoom_still_estimators.size())
 			throw std::runtime_error("still_estimators and "
 				"zoom_still_estimators have different sizes");
+		check_cancelled();
+		set_still_estimation(fuzz_range);
+
+		// Poses are only kept within a window of frames around pos, which
+		// covers every frame possibly required for generating the return
+		// value, the frames they track from, and the frames of the next few
+		// calls as lookahead.
+		std::size_t padding = pose_padding(fuzz_range, anti_crossing,
+			zoom, zoom_range);
+		std::size_t track_padding =
+			std::max(tracking.period, reuse.period) - 1;
+		std::size_t window_first = (pos > padding + track_padding ?
+			pos - padding - track_padding : 0);
+		std::size_t window_size = 4 * padding + 2 + track_padding;
+		unzoomed_still_poses.set_window(window_first, window_size);
+		still_poses.set_window(window_first, window_size);
+		processed_poses.set_window(window_first, window_size);
+		images.set_default_images(zoom ? 2 * zoom_range + 1 : 0);
+		images.retain(window_first, window_size);
+		retain_references(window_first, window_size);
+		set_processing(max_lengths, anti_crossing);
 
 		if (still_estimators.size() > 1) {
 			// multi-thread support (preprocessing)
 
-			// zoomed_used only tracks zoomed tasks of frames which should be
-			// zoomed. unzoomed_used tracks unzoomed tasks of all frames.
-			std::unordered_set<std::size_t> unzoomed_used, zoomed_used;	// pos
-
-			// A task is removed from the queue only if it is certain to finish
-			// without dependending on any unfinished task. If a task is in the
-			// queue, then it has not been claimed yet.
-			std::list<std::pair<std::size_t, bool>> queue;	// pos, zoomed
+			// Zoomed tasks are only added for frames which should be zoomed.
+			// Unzoomed tasks are added for all frames. A task is taken from the
+			// graph only if it is certain to finish without dependending on
+			// any unfinished task.
+			Concurrency<ImagePtr> concurrency;
+			auto &graph = concurrency.graph;
 
-			// Populate the queue: this should cover every still estimation
+			// Add primary tasks: this should cover every still estimation
 			// possibly required for generating the return value.
 			std::size_t range_l, range_r;
 			std::tie(range_l, range_r) =
@@ -143,235 +193,913 @@ public:
 			if (anti_crossing && range_r < length - 1)
 				range_r++;
 
+			decide_keyframes(std::min(range_r + (zoom ? zoom_range : 0),
+					length - 1), zoom, zoom_rate,
+				**still_estimators.begin(), callback);
+
 			for (std::size_t i = range_l; i <= range_r; i++) {
-				if (needs_zoom(zoom, i, zoom_rate) &&
-						still_poses.find(i) == still_poses.end() &&
-						zoomed_used.find(i) == zoomed_used.end()) {
-					std::size_t zoom_l, zoom_r;
-					std::tie(zoom_l, zoom_r) = libaction::still::single
-						::zoom::get_zoom_lr(i, length, zoom_range);
-
-					for (std::size_t j = zoom_l; j <= zoom_r; j++) {
-						if (needs_zoom(zoom, j, zoom_rate)) {
-							if (unzoomed_still_poses.find(j) == unzoomed_still_poses.end() &&
-									unzoomed_used.find(j) == unzoomed_used.end()) {
-								unzoomed_used.insert(j);
-								queue.push_back({ j, false });
-							}
-						} else {
-							if (still_poses.find(j) == still_poses.end() &&
-									unzoomed_used.find(j) == unzoomed_used.end()) {
-								unzoomed_used.insert(j);
-								queue.push_back({ j, false });
-							}
-						}
-					}
+				add_tasks(graph, i, false, length, zoom, zoom_range,
+					zoom_rate);
+			}
 
-					zoomed_used.insert(i);
-					queue.push_back({ i, true });
-				} else if (!needs_zoom(zoom, i, zoom_rate) &&
-						still_poses.find(i) == still_poses.end() &&
-						unzoomed_used.find(i) == unzoomed_used.end()) {
-					unzoomed_used.insert(i);
-					queue.push_back({ i, false });
+			// Add extra tasks to make multithread truly effective. Extra tasks,
+			// along with the frames required for zoom, must be within the
+			// window. They must not depend on `length` either, which may grow
+			// between calls (see Stream). If there is no primary task, we
+			// don't need extra.
+			if (!graph.empty()) {
+				std::size_t zoom_padding = (zoom ? zoom_range : 0);
+				std::size_t extra_l = window_first + zoom_padding;
+				std::size_t extra_r = std::min(
+					length > zoom_padding ? length - zoom_padding : 0,
+					window_first + window_size - zoom_padding);
+
+				for (std::size_t i = range_r + 1; i < extra_r; i++) {
+					add_tasks(graph, i, true, length, zoom, zoom_range,
+						zoom_rate);
+				}
+				for (std::size_t i = range_l; i > extra_l; i--) {
+					add_tasks(graph, i - 1, true, length, zoom, zoom_range,
+						zoom_rate);
 				}
 			}
 
-			std::list<std::pair<std::size_t, bool>> extra_queue;	// pos, zoomed
+			if (!graph.empty()) {
+				concurrent_run(length, zoom, zoom_range, zoom_rate,
+					still_estimators, zoom_still_estimators, callback,
+					concurrency);
+			}
+		}
 
-			// Add extra tasks to make multithread truly effective.
-			for (std::size_t i = range_r + 1; ; ) {
-				// if the queue is empty, we don't need extra
-				if (queue.empty())
-					break;
+		auto fuzz_cb = [pos, length, &max_lengths, anti_crossing, zoom, zoom_range, zoom_rate, &still_estimators, &zoom_still_estimators, &callback, this]
+			(std::size_t offset, bool left)
+				-> std::pair<bool, const libaction::Human *>
+		{
+			return fuzz_callback(pos, length, max_lengths, anti_crossing,
+				zoom, zoom_range, zoom_rate,
+				**still_estimators.begin(), **zoom_still_estimators.begin(),
+				callback, offset, left);
+		};
 
-				if (i >= length) {
-					if (range_l == 0)
-						break;
-					else
-						i = range_l - 1;
-				}
+		auto human = fuzz::fuzz(fuzz_range, fuzz_cb);
 
-				if (needs_zoom(zoom, i, zoom_rate) &&
-						still_poses.find(i) == still_poses.end() &&
-						zoomed_used.find(i) == zoomed_used.end()) {
-					std::size_t zoom_l, zoom_r;
-					std::tie(zoom_l, zoom_r) = libaction::still::single
-						::zoom::get_zoom_lr(i, length, zoom_range);
-
-					for (std::size_t j = zoom_l; j <= zoom_r; j++) {
-						if (needs_zoom(zoom, j, zoom_rate)) {
-							if (unzoomed_still_poses.find(j) == unzoomed_still_poses.end() &&
-									unzoomed_used.find(j) == unzoomed_used.end()) {
-								unzoomed_used.insert(j);
-								extra_queue.push_back({ j, false });
-							}
-						} else {
-							if (still_poses.find(j) == still_poses.end() &&
-									unzoomed_used.find(j) == unzoomed_used.end()) {
-								unzoomed_used.insert(j);
-								extra_queue.push_back({ j, false });
-							}
-						}
-					}
+		return get_human_pose(human);
+	}
 
-					zoomed_used.insert(i);
-					extra_queue.push_back({ i, true });
-				} else if (!needs_zoom(zoom, i, zoom_rate) &&
-						still_poses.find(i) == still_poses.end() &&
-						unzoomed_used.find(i) == unzoomed_used.end()) {
-					unzoomed_used.insert(i);
-					extra_queue.push_back({ i, false });
-				}
+	/// Estimate for all frames from a series of motion images.
+
+	/// The result is the same as calling estimate() for every frame in order,
+	/// but the still estimations of the whole series are scheduled at once,
+	/// and the fuzz estimations of all frames are also shared among the
+	/// worker threads. The still poses of all frames are kept until the next
+	/// call.
+	///
+	/// See estimate() for the parameters.
+	///
+	/// @return                 Action data of all frames.
+	/// @exception              std::runtime_error
+	/// @sa                     estimate and postprocess
+	template<typename StillEstimator, typename ZoomStillEstimator,
+		typename ImagePtr>
+	inline std::unique_ptr<std::list<
+		std::unordered_map<std::size_t, libaction::Human>>>
+	estimate_all(
+		std::size_t length,
+		std::size_t fuzz_range,
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths,
+		bool anti_crossing,
+		bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
+		const std::vector<StillEstimator*> &still_estimators,
+		const std::vector<ZoomStillEstimator*> &zoom_still_estimators,
+		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+			&callback
+	) {
+		return postprocess(0, length, length, fuzz_range, max_lengths,
+			anti_crossing, zoom, zoom_range, zoom_rate,
+			still_estimators, zoom_still_estimators, callback);
+	}
 
-				// increment
-				if (i > range_r) {
-					i++;
-					if (i >= length) {
-						if (range_l == 0)
-							break;
-						else
-							i = range_l - 1;
-					}
-				} else {
-					if (i == 0)
-						break;
-					i--;
-				}
-			}
+	/// Estimate for a range of frames from a series of motion images.
+
+	/// Still poses of the whole series are kept, so that the frames can be
+	/// processed again with different `fuzz_range`, `max_lengths` or
+	/// `anti_crossing` without still estimation. Missing still poses are
+	/// estimated first, as in estimate_all(). Then anti crossing and
+	/// max_lengths are applied, followed by fuzz estimation, each shared
+	/// among the worker threads on contiguous ranges of frames, while the
+	/// still poses are only read. Still poses are kept until a call to
+	/// estimate() or reset(). Call reset() before processing again with
+	/// different zoom parameters.
+	///
+	/// @param[in]  first       The first frame to estimate.
+	/// @param[in]  last        The frame after the last frame to estimate.
+	///                         Must be greater than `first` and not greater
+	///                         than `length`.
+	///
+	/// See estimate() for the other parameters.
+	///
+	/// @return                 Action data of the frames in [first, last).
+	/// @exception              std::runtime_error
+	/// @sa                     estimate_all
+	template<typename StillEstimator, typename ZoomStillEstimator,
+		typename ImagePtr>
+	inline std::unique_ptr<std::list<
+		std::unordered_map<std::size_t, libaction::Human>>>
+	postprocess(
+		std::size_t first, std::size_t last, std::size_t length,
+		std::size_t fuzz_range,
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths,
+		bool anti_crossing,
+		bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
+		const std::vector<StillEstimator*> &still_estimators,
+		const std::vector<ZoomStillEstimator*> &zoom_still_estimators,
+		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+			&callback
+	) {
+		if (length == 0)
+			throw std::runtime_error("length == 0");
+		if (first >= last)
+			throw std::runtime_error("first >= last");
+		if (last > length)
+			throw std::runtime_error("last > length");
+		if (zoom_rate == 0)
+			throw std::runtime_error("zoom_rate == 0");
+		if (still_estimators.empty())
+			throw std::runtime_error("still_estimators is empty");
+		if (still_estimators.size() != zoom_still_estimators.size())
+			throw std::runtime_error("still_estimators and "
+				"zoom_still_estimators have different sizes");
+		check_cancelled();
+
+		// the window covers the whole series
+		unzoomed_still_poses.set_window(0, length);
+		still_poses.set_window(0, length);
+		processed_poses.set_window(0, length);
+		images.set_default_images(zoom ? 2 * zoom_range + 1 : 0);
+		images.retain(0, length);
+		set_still_estimation(fuzz_range);
+		retain_references(0, length);
+		set_processing(max_lengths, anti_crossing);
+
+		// frames required for fuzz estimation, and for anti crossing of them
+		std::size_t fuzz_l = fuzz::get_fuzz_lr(first, length, fuzz_range).first;
+		std::size_t fuzz_r = fuzz::get_fuzz_lr(last - 1, length, fuzz_range)
+			.second;
+		std::size_t still_l = fuzz_l, still_r = fuzz_r;
+		if (anti_crossing && still_l > 0)
+			still_l--;
+		if (anti_crossing && still_r < length - 1)
+			still_r++;
 
-			if (!queue.empty()) {
-				// start the threads
-
-				std::mutex mutex;
-				std::condition_variable cv;
-				std::vector<std::unique_ptr<bool>> statuses;
-				bool end = false;
-
-				std::vector<std::thread> threads;
-
-				auto it = still_estimators.begin();
-				auto zoom_it = zoom_still_estimators.begin();
-
-				for (; it != still_estimators.end()
-						&& zoom_it != zoom_still_estimators.end();
-					it++, zoom_it++)
-				{
-					statuses.push_back(std::unique_ptr<bool>(
-						new bool(false)));
-
-					threads.push_back(std::thread(
-						std::bind(
-							&Estimator::concurrent_preestimate<
-								StillEstimator, ZoomStillEstimator, ImagePtr>,
-							this,
-							length, zoom, zoom_range, zoom_rate,
-							std::ref(**it), std::ref(**zoom_it),
-							std::cref(callback),
-							std::ref(queue), std::ref(extra_queue),
-							std::ref(mutex), std::ref(cv),
-							std::ref(*statuses.back()), std::ref(end))));
-				}
+		if (still_estimators.size() > 1) {
+			// multi-thread support (preprocessing)
 
-				std::unique_lock<std::mutex> lock(mutex);
+			// Every task is primary. Zoomed tasks are started as soon as
+			// their dependencies finish, so that images are fetched in
+			// order and shortly used twice if they should be zoomed.
+			Concurrency<ImagePtr> concurrency;
+			decide_keyframes(std::min(still_r + (zoom ? zoom_range : 0),
+					length - 1), zoom, zoom_rate,
+				**still_estimators.begin(), callback);
+			for (std::size_t i = still_l; i <= still_r; i++) {
+				add_tasks(concurrency.graph, i, false, length,
+					zoom, zoom_range, zoom_rate);
+			}
 
-				while (true) {
-					// statuses are all false
+			if (!concurrency.graph.empty()) {
+				concurrent_run(length, zoom, zoom_range, zoom_rate,
+					still_estimators, zoom_still_estimators, callback,
+					concurrency);
+			}
+		}
 
-					for (std::size_t i = 0; i < threads.size(); i++) {
-						bool &status = *statuses[i];
-						cv.wait(lock, [&status] { return status; });
+		// Still poses not estimated yet are estimated single-threadedly,
+		// so that the steps below only read still poses.
+		for (std::size_t i = still_l; i <= still_r; i++) {
+			fuzz_callback_before_anti_crossing(i, length,
+				zoom, zoom_range, zoom_rate,
+				**still_estimators.begin(), **zoom_still_estimators.begin(),
+				callback, 0, false);
+		}
+
+		// Run `job` for every frame in [l, r), on contiguous ranges of
+		// frames if multithreaded. Each frame is only written by its own job.
+		auto for_frames = [&] (std::size_t l, std::size_t r,
+				const std::function<
+					void(std::size_t worker, std::size_t pos)> &job) {
+			if (still_estimators.size() > 1) {
+				std::size_t size = still_estimators.size();
+				start_workers(size);
+				workers->start([&] (std::size_t worker) {
+					for (std::size_t pos = l + (r - l) * worker / size;
+							pos < l + (r - l) * (worker + 1) / size; pos++) {
+						check_cancelled();
+						job(worker, pos);
 					}
+				});
+				workers->wait();
+			} else {
+				for (std::size_t pos = l; pos < r; pos++) {
+					check_cancelled();
+					job(0, pos);
+				}
+			}
+		};
 
-					// statuses are all true
+		// anti crossing and max_lengths, so that fuzz estimation below only
+		// reads processed poses
+		for_frames(fuzz_l, fuzz_r + 1,
+			[&] (std::size_t worker, std::size_t pos) {
+				fuzz_callback(pos, length, max_lengths,
+					anti_crossing, zoom, zoom_range, zoom_rate,
+					*still_estimators[worker], *zoom_still_estimators[worker],
+					callback, 0, false);
+			});
+
+		// fuzz estimation
+		std::vector<std::unique_ptr<libaction::Human>> humans(last - first);
+		for_frames(first, last, [&] (std::size_t worker, std::size_t pos) {
+			auto fuzz_cb = [pos, length, &max_lengths, anti_crossing, zoom, zoom_range, zoom_rate, &still_estimators, &zoom_still_estimators, &callback, worker, this]
+				(std::size_t offset, bool left)
+					-> std::pair<bool, const libaction::Human *>
+			{
+				return fuzz_callback(pos, length, max_lengths,
+					anti_crossing, zoom, zoom_range, zoom_rate,
+					*still_estimators[worker],
+					*zoom_still_estimators[worker],
+					callback, offset, left);
+			};
+
+			humans[pos - first] = fuzz::fuzz(fuzz_range, fuzz_cb);
+		});
+
+		auto action = std::unique_ptr<std::list<
+			std::unordered_map<std::size_t, libaction::Human>>>(
+				new std::list<
+					std::unordered_map<std::size_t, libaction::Human>>());
+		for (auto &human: humans)
+			action->push_back(std::move(*get_human_pose(human)));
+
+		return action;
+	}
 
-					if (queue.empty())
-						end = true;
+	/// Set up prefetching for multithread estimation.
+
+	/// Prefetching only takes effect if more than one still estimator is
+	/// used. Without prefetching, images are fetched by the estimation
+	/// threads themselves.
+	///
+	/// @param[in]  threads     The number of threads calling the image
+	///                         callback ahead of the estimation threads, or 0
+	///                         to turn off prefetching.
+	/// @param[in]  images      The maximum number of images fetched ahead and
+	///                         not yet taken by an estimation thread. Must be
+	///                         greater than 0 if `threads` is not 0.
+	/// @exception              std::runtime_error
+	inline void set_prefetch(std::size_t threads, std::size_t images)
+	{
+		if (threads != 0 && images == 0)
+			throw std::runtime_error("images == 0");
 
-					for (std::size_t i = 0; i < threads.size(); i++) {
-						bool &status = *statuses[i];
-						status = false;
-					}
+		prefetch_threads = threads;
+		prefetch_images = images;
+		if (threads == 0)
+			prefetch_workers.reset();
+	}
 
-					// statuses are all false
+	/// Set the memory budget of the image cache.
+
+	/// When zoom is enabled, the image of a frame which should be zoomed is
+	/// needed twice. If there is room in the budget, the image is kept in the
+	/// cache between the two uses and only fetched once, as the last access.
+	/// Otherwise it is fetched as the last access for the unzoomed estimation,
+	/// and fetched again only if the zoomed estimation is done. The size of
+	/// an image is estimated from the last image cached.
+	///
+	/// By default, the budget is `2 * zoom_range + 1` images, sized from the
+	/// first image cached.
+	///
+	/// @param[in]  bytes       The budget in bytes, or 0 to turn off the
+	///                         cache.
+	inline void set_image_cache(std::size_t bytes)
+	{
+		images.set_budget(bytes);
+	}
 
-					lock.unlock();
-					cv.notify_all();
-					lock.lock();
+	/// Statistics of estimation.
+	struct Stats
+	{
+		/// The number of zoom reestimations done.
+		std::size_t zooms;
+		/// The number of zoom reestimations skipped by the zoom policy.
+		std::size_t skipped_zooms;
+		/// The number of frames left to fuzz estimation as they are not
+		/// keyframes.
+		std::size_t non_keyframes;
+		/// The number of still estimations done on a tracked region.
+		std::size_t tracked;
+		/// The number of still estimations done on a tracked region, but
+		/// done again on the full image as the track is lost.
+		std::size_t lost_tracks;
+		/// The number of still estimations skipped by reusing the still pose
+		/// of the frame before.
+		std::size_t reused_frames;
+	};
+
+	/// Set the policy deciding whether zoom reestimation is done for a frame
+	/// which should be zoomed, based on its unzoomed pose.
+
+	/// The policy only applies to poses estimated afterwards. See reset().
+	///
+	/// @param[in]  policy      The zoom policy. The default policy never
+	///                         skips zoom reestimation.
+	inline void set_zoom_policy(
+		const libaction::still::single::zoom::Policy &policy)
+	{
+		zoom_policy = policy;
+	}
 
-					if (end)
-						break;
-				}
+	/// Estimate still poses on keyframes only.
+
+	/// Still estimation is skipped on frames other than keyframes, which are
+	/// filled by fuzz estimation from the keyframes around them instead. The
+	/// stride between keyframes adapts to the motion observed on the
+	/// keyframes before: body parts are expected to move by at most
+	/// `max_motion` between keyframes, so keyframes are dense during fast
+	/// motion and sparse when still. The stride is limited by `fuzz_range`,
+	/// so that every frame can be reached by fuzz estimation from keyframes on
+	/// both sides.
+	///
+	/// Keyframes are decided in order from frame 0, so they work best with
+	/// frames estimated in order. The still poses of keyframes before any
+	/// multithread estimation are estimated on the calling thread, as each
+	/// keyframe depends on the ones before.
+	///
+	/// Still poses cached are dropped on the next estimation if the
+	/// keyframes change, including when a different `fuzz_range` limits the
+	/// stride differently.
+	///
+	/// @param[in]  max_stride  The maximum stride between keyframes, or 1 to
+	///                         turn off keyframes.
+	/// @param[in]  max_motion  The expected motion of a body part between
+	///                         keyframes, in the coordinates of body parts.
+	inline void set_keyframes(std::size_t max_stride, float max_motion)
+	{
+		keyframe_stride = max_stride;
+		keyframe_motion = max_motion;
+	}
 
-				lock.unlock();
+	/// Estimate still poses on tracked regions.
+
+	/// The region of the human in a frame is predicted from the still poses
+	/// of the frames before it, and still estimation is done on that region
+	/// only instead of the full image. The still pose is estimated on the
+	/// full image if no region is predicted, i.e. when no human is found in
+	/// the frame before, or if the human found in the region is not
+	/// confident enough. Every `period` frames, the track restarts from a
+	/// still pose estimated on the full image, so that the still pose of a
+	/// frame never depends on more than `period` - 1 frames before it.
+	///
+	/// The still poses tracked from are estimated before zoom reestimation.
+	/// Frames other than keyframes are not tracked from (see
+	/// set_keyframes()). Multithread estimation is limited within a track,
+	/// as each still estimation waits for the ones it tracks from.
+	///
+	/// Still poses cached are dropped on the next estimation if the
+	/// parameters change.
+	///
+	/// @param[in]  period      The number of frames between restarts of the
+	///                         track, or 1 to turn off tracking. Must be
+	///                         greater than 0.
+	/// @param[in]  margin      The margin around the predicted bounding box of
+	///                         the human on each side, relative to its size.
+	/// @param[in]  min_score   The minimum mean score of the body parts of a
+	///                         human found in the region.
+	/// @exception              std::runtime_error
+	inline void set_tracking(std::size_t period, float margin, float min_score)
+	{
+		if (period == 0)
+			throw std::runtime_error("period == 0");
 
-				for (auto &thread: threads)
-					thread.join();
-			}
+		next_tracking = Tracking{ period, margin, min_score };
+	}
 
-			// TODO: Handle errors from other threads. If they are not handled,
-			//       it's a waste of time to continue single-threadedly.
-		}
+	/// Reuse still poses on static frames.
+
+	/// A thumbnail of each image is compared with the thumbnail of the image
+	/// the still pose of the frame before is estimated on. If they barely
+	/// differ, that still pose is reused instead of doing still estimation.
+	/// Every `period` frames, still estimation is done anyway, so that the
+	/// still pose of a frame never depends on more than `period` - 1 frames
+	/// before it.
+	///
+	/// Only the still poses before zoom reestimation are reused. Frames other
+	/// than keyframes are not reused from (see set_keyframes()).
+	/// Multithread estimation is limited within a period, as each still
+	/// estimation waits for the one it may reuse.
+	///
+	/// Still poses cached are dropped on the next estimation if the
+	/// parameters change.
+	///
+	/// @param[in]  max_difference  The maximum mean absolute difference
+	///                         between thumbnails, in the unit of image
+	///                         elements, for reusing a still pose.
+	/// @param[in]  period      The number of frames between forced still
+	///                         estimations, or 1 to turn off reusing. Must be
+	///                         greater than 0.
+	/// @exception              std::runtime_error
+	/// @sa                     libaction::detail::image::thumbnail
+	inline void set_reuse(float max_difference, std::size_t period)
+	{
+		if (period == 0)
+			throw std::runtime_error("period == 0");
 
-		std::function<
-				std::pair<bool, std::unique_ptr<const libaction::Human>>
-				(std::size_t, bool)>
-		fuzz_cb = [pos, length, &max_lengths, anti_crossing, zoom, zoom_range, zoom_rate, &still_estimators, &zoom_still_estimators, &callback, this]
-			(std::size_t offset, bool left)
-				-> std::pair<bool, std::unique_ptr<const libaction::Human>>
-		{
-			return fuzz_callback(pos, length, max_lengths, anti_crossing,
-				zoom, zoom_range, zoom_rate,
-				**still_estimators.begin(), **zoom_still_estimators.begin(),
-				callback, offset, left);
-		};
+		next_reuse = Reuse{ max_difference, period };
+	}
 
-		auto human = fuzz::fuzz(fuzz_range, fuzz_cb);
+	/// Get the statistics since construction or the last reset_stats().
+	inline Stats stats() const
+	{
+		return Stats{ zooms, skipped_zooms, non_keyframes,
+			tracked, lost_tracks, reused_frames };
+	}
 
-		return get_human_pose(human);
+	/// Reset the statistics.
+	inline void reset_stats()
+	{
+		zooms = 0;
+		skipped_zooms = 0;
+		non_keyframes = 0;
+		tracked = 0;
+		lost_tracks = 0;
+		reused_frames = 0;
+	}
+
+	/// Cancel estimation.
+
+	/// May be called from any thread. The running estimation, if any, stops
+	/// as soon as the still estimations in progress finish, and throws
+	/// std::runtime_error. Further estimations throw as well, until reset()
+	/// is called.
+	inline void cancel()
+	{
+		cancelled = true;
 	}
 
 	/// Reset the status of Estimator.
 
-	///	This is necessary when the stream is changed.
+	///	This is necessary when the stream is changed, or after cancel().
 	inline void reset()
 	{
 		unzoomed_still_poses.clear();
 		still_poses.clear();
+		processed_poses.clear();
+		images.clear();
+		references.clear();
+		keyframes.clear();
+		cancelled = false;
 	}
 
 private:
+	using PoseCache = detail::BasicPoseCache<PackedPoses>;
+	using pose_ptr = typename PoseCache::pose_ptr;
+
+	// workers for multithread estimation, one per still estimator
+	std::unique_ptr<libaction::detail::WorkerPool> workers{};
+
+	// workers for prefetching images in multithread estimation
+	std::unique_ptr<libaction::detail::WorkerPool> prefetch_workers{};
+	std::size_t prefetch_threads = 0;
+	std::size_t prefetch_images = 0;
+
+	// images kept between their unzoomed and zoomed estimations
+	detail::ImageCache images{};
+
+	// set by cancel()
+	std::atomic<bool> cancelled{ false };
+
+	libaction::still::single::zoom::Policy zoom_policy{};
+
+	// see Stats
+	std::atomic<std::size_t> zooms{ 0 }, skipped_zooms{ 0 }, non_keyframes{ 0 };
+	std::atomic<std::size_t> tracked{ 0 }, lost_tracks{ 0 }, reused_frames{ 0 };
+
+	// see set_keyframes()
+	std::size_t keyframe_stride = 1;
+	float keyframe_motion = 0.0f;
+	detail::KeyframeSchedule keyframes{};
+
+	// see set_tracking(): the parameters still poses are estimated with, and
+	// the parameters taking effect on the next estimation
+	struct Tracking
+	{
+		std::size_t period;
+		float margin;
+		float min_score;
+	};
+	Tracking tracking{ 1, 0.0f, 0.0f }, next_tracking{ 1, 0.0f, 0.0f };
+
+	// see set_reuse(), as for Tracking
+	struct Reuse
+	{
+		float max_difference;
+		std::size_t period;
+	};
+	Reuse reuse{ 0.0f, 1 }, next_reuse{ 0.0f, 1 };
+
+	// the number of cells along each side of a thumbnail
+	static constexpr std::size_t thumbnail_size = 16;
+
+	// Thumbnails of the images the still poses before zoom reestimation are
+	// estimated on, by frame, if reusing is on. Entries outside the pose
+	// window are dropped on the next estimation.
+	std::unordered_map<std::size_t,
+		std::shared_ptr<const std::vector<float>>> references{};
+
 	// poses which should be zoomed, estimated on their unzoomed image
-	std::unordered_map<std::size_t, std::unique_ptr<libaction::Human>> unzoomed_still_poses{};
+	PoseCache unzoomed_still_poses{};
 
 	// poses estimated on their zoomed image if they should be zoomed,
 	// otherwise poses estimated on their unzoomed image
-	std::unordered_map<std::size_t, std::unique_ptr<libaction::Human>> still_poses{};
+	PoseCache still_poses{};
+
+	// still_poses after anti crossing and max_lengths, along with the
+	// parameters they are processed with. They are never packed, so that
+	// fuzz estimation can borrow them.
+	detail::PlainPoseCache processed_poses{};
+	std::vector<std::tuple<
+		libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+		float>> processed_max_lengths{};
+	bool processed_anti_crossing = false;
+
+	// The maximum distance between pos and the frames whose still poses are
+	// required for estimating pos.
+	static inline constexpr std::size_t pose_padding(std::size_t fuzz_range,
+		bool anti_crossing, bool zoom, std::size_t zoom_range)
+	{
+		return (fuzz_range != 0 ? fuzz_range - 1 : 0) +
+			(anti_crossing ? 1 : 0) + (zoom ? zoom_range : 0);
+	}
+
+	// Drop processed poses if they are processed with different parameters.
+	inline void set_processing(
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths,
+		bool anti_crossing)
+	{
+		if (max_lengths == processed_max_lengths &&
+				anti_crossing == processed_anti_crossing)
+			return;
+
+		processed_poses.clear();
+		processed_max_lengths = max_lengths;
+		processed_anti_crossing = anti_crossing;
+	}
+
+	// Drop still poses if keyframes or tracking change, restarting the
+	// keyframes.
+	inline void set_still_estimation(std::size_t fuzz_range)
+	{
+		// frames between keyframes must be within the fuzz range of both
+		bool changed = keyframes.set_parameters(
+			std::min(keyframe_stride, fuzz_range), keyframe_motion);
+
+		if (next_tracking.period != tracking.period ||
+				next_tracking.margin != tracking.margin ||
+				next_tracking.min_score != tracking.min_score) {
+			tracking = next_tracking;
+			keyframes.clear();
+			changed = true;
+		}
+		if (next_reuse.max_difference != reuse.max_difference ||
+				next_reuse.period != reuse.period) {
+			reuse = next_reuse;
+			keyframes.clear();
+			changed = true;
+		}
+
+		if (!changed)
+			return;
+
+		references.clear();
+
+		unzoomed_still_poses.clear();
+		still_poses.clear();
+		processed_poses.clear();
+	}
+
+	// Whether pos is a decided keyframe, or keyframes are off.
+	inline bool known_keyframe(std::size_t pos) const
+	{
+		return !keyframes.enabled() ||
+			(pos < keyframes.decided() && keyframes.is_keyframe(pos));
+	}
+
+	// Drop the thumbnails outside of [first, first + size).
+	inline void retain_references(std::size_t first, std::size_t size)
+	{
+		for (auto it = references.begin(); it != references.end(); ) {
+			if (it->first >= first && it->first - first < size)
+				it++;
+			else
+				it = references.erase(it);
+		}
+	}
+
+	// Up to `count` keyframes before pos since the last multiple of period,
+	// the last one last.
+	inline std::vector<std::size_t> frames_before(std::size_t pos,
+		std::size_t period, std::size_t count) const
+	{
+		std::vector<std::size_t> frames;
+
+		std::size_t first = pos - pos % period;
+		for (std::size_t i = pos; i > first && frames.size() < count; i--) {
+			if (known_keyframe(i - 1))
+				frames.insert(frames.begin(), i - 1);
+		}
+
+		return frames;
+	}
+
+	// The frames pos tracks from, the last one last.
+	inline std::vector<std::size_t> tracked_frames(std::size_t pos) const
+	{
+		return frames_before(pos, tracking.period, 2);
+	}
+
+	// The frame whose pose may be reused at pos, if any.
+	inline std::vector<std::size_t> reused_frames_of(std::size_t pos) const
+	{
+		return frames_before(pos, reuse.period, 1);
+	}
+
+	// The frames whose still poses before zoom reestimation are required for
+	// estimating the one at pos, in order.
+	inline std::vector<std::size_t> source_frames(std::size_t pos) const
+	{
+		auto frames = tracked_frames(pos);
+		for (auto frame: reused_frames_of(pos)) {
+			if (std::find(frames.begin(), frames.end(), frame) == frames.end())
+				frames.push_back(frame);
+		}
+		std::sort(frames.begin(), frames.end());
+
+		return frames;
+	}
+
+	// The thumbnail of the image the still pose at pos is estimated on,
+	// which must exist.
+	inline std::shared_ptr<const std::vector<float>> reference_of(
+		std::size_t pos) const
+	{
+		auto it = references.find(pos);
+		if (it == references.end())
+			throw std::runtime_error("cannot find thumbnail of frame");
+		return it->second;
+	}
+
+	// Predict the region at pos from the poses at the frames it tracks from.
+	inline bool track_region(std::size_t pos,
+		const std::vector<std::size_t> &frames,
+		const std::vector<pose_ptr> &poses,
+		detail::Region &region) const
+	{
+		if (frames.empty())
+			return false;
+		if (frames.size() == 1) {
+			return detail::predict_region(pos, frames[0], poses[0].get(),
+				0, nullptr, tracking.margin, region);
+		}
+		return detail::predict_region(pos, frames[1], poses[1].get(),
+			frames[0], poses[0].get(), tracking.margin, region);
+	}
+
+	// Estimate the still pose before zoom reestimation on image. The pose
+	// `previous` is reused if image barely differs from `previous_reference`.
+	// Otherwise the pose is estimated, on region if any, and the thumbnail of
+	// image is stored in reference.
+	template<typename StillEstimator, typename Image>
+	inline std::unique_ptr<libaction::Human> estimate_base_pose(
+		const Image &image, const detail::Region *region,
+		const std::shared_ptr<const std::vector<float>> &previous_reference,
+		const libaction::Human *previous,
+		StillEstimator &still_estimator,
+		std::shared_ptr<const std::vector<float>> &reference)
+	{
+		if (reuse.period > 1) {
+			auto thumbnail = std::make_shared<std::vector<float>>(
+				libaction::detail::image::thumbnail(image, thumbnail_size));
+
+			if (previous_reference &&
+					libaction::detail::image::thumbnail_difference(
+						*thumbnail, *previous_reference)
+						<= reuse.max_difference) {
+				reused_frames++;
+				reference = previous_reference;
+
+				std::unique_ptr<libaction::Human> human;
+				if (previous)
+					human.reset(new libaction::Human(*previous));
+				return human;
+			}
+
+			reference = std::move(thumbnail);
+		}
+
+		return estimate_still_pose_tracked(image, region, still_estimator);
+	}
+
+	// Estimate the still pose on image, on region if any. The full image is
+	// used instead if the human found in region is not confident enough.
+	template<typename StillEstimator, typename Image>
+	inline std::unique_ptr<libaction::Human> estimate_still_pose_tracked(
+		const Image &image, const detail::Region *region,
+		StillEstimator &still_estimator)
+	{
+		if (region) {
+			using region_cb_arg = boost::multi_array<
+				typename Image::element, 3>;
+			std::function<std::unique_ptr<libaction::Human>
+				(const region_cb_arg&)> region_cb =
+			[&still_estimator] (const region_cb_arg &image_to_estimate) {
+				return estimate_still_pose_from_image(image_to_estimate,
+					still_estimator);
+			};
+			auto human = libaction::still::single::zoom::region_estimate(
+				image, region->x1, region->x2, region->y1, region->y2,
+				region_cb);
+			tracked++;
+
+			if (human && detail::mean_score(*human) >= tracking.min_score)
+				return human;
+			lost_tracks++;
+		}
+
+		return estimate_still_pose_from_image(image, still_estimator);
+	}
+
+	// The still pose at pos before zoom reestimation, which is the pose
+	// tracked from and the pose deciding keyframes. It is only cached within
+	// the window.
+	template<typename StillEstimator, typename ImagePtr>
+	inline pose_ptr base_pose(std::size_t pos,
+		bool zoom, std::size_t zoom_rate,
+		StillEstimator &still_estimator,
+		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+			&callback)
+	{
+		bool eventually_zoom = needs_zoom(zoom, pos, zoom_rate);
+		auto &poses = (eventually_zoom ? unzoomed_still_poses : still_poses);
+
+		if (poses.contains(pos))
+			return poses.get(pos);
+
+		auto frames = tracked_frames(pos);
+		std::vector<pose_ptr> tracked_poses;
+		for (auto frame: frames) {
+			tracked_poses.push_back(base_pose(frame, zoom, zoom_rate,
+				still_estimator, callback));
+		}
+		detail::Region region;
+		bool has_region = track_region(pos, frames, tracked_poses, region);
+
+		pose_ptr previous;
+		std::shared_ptr<const std::vector<float>> previous_reference;
+		for (auto frame: reused_frames_of(pos)) {
+			previous = base_pose(frame, zoom, zoom_rate, still_estimator,
+				callback);
+			previous_reference = reference_of(frame);
+		}
+
+		bool cached = poses.in_window(pos);
+		auto image = get_image(pos, !eventually_zoom || !cached, callback);
+		std::shared_ptr<const std::vector<float>> reference;
+		auto human = estimate_base_pose(**image,
+			has_region ? &region : nullptr, previous_reference,
+			previous.get(), still_estimator, reference);
+		if (reference)
+			references[pos] = std::move(reference);
+
+		if (!cached) {
+			return pose_ptr(human.release(),
+				[] (const libaction::Human *ptr) { delete ptr; });
+		}
+		poses.insert(pos, std::move(human));
+		return poses.get(pos);
+	}
+
+	// Decide the keyframes up to pos, estimating the keyframes before it.
+	template<typename StillEstimator, typename ImagePtr>
+	inline void decide_keyframes(std::size_t pos,
+		bool zoom, std::size_t zoom_rate,
+		StillEstimator &still_estimator,
+		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+			&callback)
+	{
+		if (!keyframes.enabled())
+			return;
+
+		while (keyframes.decided() <= pos) {
+			check_cancelled();
+			keyframes.advance(base_pose(keyframes.last(), zoom, zoom_rate,
+				still_estimator, callback).get());
+		}
+	}
+
+	// Whether zoom is skipped at pos by the zoom policy. The unzoomed pose at
+	// pos must exist.
+	inline bool zoom_skipped(std::size_t pos) const
+	{
+		auto unzoomed = unzoomed_still_poses.get(pos);
+		return unzoomed && !zoom_policy.should_zoom(*unzoomed);
+	}
+
+	// Whether the image of a task is needed. The image of a zoomed task is
+	// not needed if no human is found in the unzoomed image or zoom is
+	// skipped.
+	inline bool image_needed(const detail::TaskGraph::Task &task) const
+	{
+		if (!task.second)
+			return true;
+
+		auto unzoomed = unzoomed_still_poses.get(task.first);
+		return unzoomed && zoom_policy.should_zoom(*unzoomed);
+	}
+
+	inline void check_cancelled() const
+	{
+		if (cancelled)
+			throw std::runtime_error("estimation cancelled");
+	}
 
 	static inline constexpr bool needs_zoom(bool zoom, std::size_t pos, std::size_t zoom_rate)
 	{
 		return zoom && (zoom_rate != 0) && (pos % zoom_rate == 0);
 	}
 
-	inline bool zoom_estimation_possible(
-		std::size_t pos, std::size_t length, std::size_t zoom_range, std::size_t zoom_rate)
+	// Add the tasks required for the final still pose at pos.
+	inline void add_tasks(detail::TaskGraph &graph, std::size_t pos,
+		bool extra, std::size_t length,
+		bool zoom, std::size_t zoom_range, std::size_t zoom_rate)
 	{
-		if (pos >= length)
-			return false;
+		// Frames other than keyframes need no still estimation, and frames
+		// not decided yet are left to the single-thread path.
+		if (!known_keyframe(pos))
+			return;
+
+		if (needs_zoom(zoom, pos, zoom_rate) &&
+				!still_poses.contains(pos) &&
+				!graph.contains_zoomed(pos)) {
+			std::size_t zoom_l, zoom_r;
+			std::tie(zoom_l, zoom_r) = libaction::still::single
+				::zoom::get_zoom_lr(pos, length, zoom_range);
+			if (keyframes.enabled() && zoom_r >= keyframes.decided())
+				return;
+
+			std::vector<std::size_t> dependencies;
+
+			for (std::size_t j = zoom_l; j <= zoom_r; j++) {
+				if (!known_keyframe(j))
+					continue;
 
-		std::size_t l, r;
-		std::tie(l, r) = libaction::still::single::zoom::get_zoom_lr(
-			pos, length, zoom_range);
+				if (!add_unzoomed_task(graph, j, extra, zoom, zoom_rate))
+					return;
+				dependencies.push_back(j);
+			}
 
-		for (std::size_t i = l; i <= r; i++) {
-			if (needs_zoom(true, i, zoom_rate) &&
-					unzoomed_still_poses.find(i) == unzoomed_still_poses.end())
-				return false;
-			if (!needs_zoom(true, i, zoom_rate) &&
-					still_poses.find(i) == still_poses.end())
+			graph.add_zoomed(pos, extra, dependencies);
+		} else if (!needs_zoom(zoom, pos, zoom_rate)) {
+			add_unzoomed_task(graph, pos, extra, zoom, zoom_rate);
+		}
+	}
+
+	// Add the unzoomed task at pos, along with the tasks it tracks from or
+	// may reuse.
+	// Returns whether the still pose before zoom reestimation at pos is
+	// estimated or going to be.
+	inline bool add_unzoomed_task(detail::TaskGraph &graph, std::size_t pos,
+		bool extra, bool zoom, std::size_t zoom_rate)
+	{
+		auto &poses = (needs_zoom(zoom, pos, zoom_rate) ?
+			unzoomed_still_poses : still_poses);
+		if (poses.contains(pos) || graph.contains_unzoomed(pos))
+			return true;
+		if (!poses.in_window(pos))
+			return false;
+
+		auto frames = source_frames(pos);
+		for (auto frame: frames) {
+			if (!add_unzoomed_task(graph, frame, extra, zoom, zoom_rate))
 				return false;
 		}
 
+		graph.add_unzoomed(pos, extra, frames);
 		return true;
 	}
 
@@ -387,6 +1115,44 @@ private:
 		return image;
 	}
 
+	// Get the image at pos, from the image cache if possible. The image is
+	// always fetched as the last access. If it will be needed again and there
+	// is room in the cache, it is cached, otherwise it is fetched again when
+	// needed. `lock`, if any, is released while fetching.
+	template<typename ImagePtr>
+	inline std::shared_ptr<const ImagePtr> get_image(
+		std::size_t pos, bool last_image_access,
+		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+			&callback,
+		std::unique_lock<std::mutex> *lock = nullptr)
+	{
+		auto cached = last_image_access ?
+			images.take<ImagePtr>(pos) : images.get<ImagePtr>(pos);
+		if (cached)
+			return cached;
+
+		bool keep = !last_image_access && images.reserve(pos);
+
+		ImagePtr image;
+		if (lock)
+			lock->unlock();
+		try {
+			image = get_image_from_callback(pos, true, callback);
+		} catch (...) {
+			if (lock)
+				lock->lock();
+			if (keep)
+				images.cancel(pos);
+			throw;
+		}
+		if (lock)
+			lock->lock();
+
+		if (keep)
+			return images.insert(pos, std::move(image));
+		return std::make_shared<ImagePtr>(std::move(image));
+	}
+
 	template<typename StillEstimator, typename Image>
 	static inline std::unique_ptr<libaction::Human>
 	estimate_still_pose_from_image(
@@ -404,36 +1170,92 @@ private:
 		return human;
 	}
 
-	template<typename StillEstimator, typename Image>
-	static inline auto estimate_still_pose_from_image_on(
-		std::size_t pos,
-		const Image &image,
-		StillEstimator &still_estimator,
-		std::unordered_map<std::size_t, std::unique_ptr<libaction::Human>> &poses)
-	-> std::remove_reference<decltype(poses)>::type::iterator
+	// Shared state of concurrent(multithread) estimation, guarded by mutex.
+	template<typename ImagePtr>
+	struct Concurrency
 	{
-		auto human = estimate_still_pose_from_image(image, still_estimator);
-		auto it = poses.insert(std::make_pair(pos, std::move(human)))
-			.first;
-
-		return it;
+		detail::TaskGraph graph{};
+
+		std::mutex mutex{};
+		std::condition_variable cv{};
+
+		// number of tasks being tried by estimation threads
+		std::size_t running_tasks = 0;
+		// number of images being fetched by prefetch threads
+		std::size_t prefetching = 0;
+		// tasks taken by prefetch threads, along with their images
+		std::deque<std::pair<detail::TaskGraph::Task,
+			std::shared_ptr<const ImagePtr>>> prefetched{};
+		// maximum size of prefetching and prefetched combined
+		std::size_t prefetch_images = 0;
+
+		bool failed = false;
+		// the first error from any thread
+		std::exception_ptr error{};
+	};
+
+	// Create the workers, unless there are already `size` of them.
+	inline void start_workers(std::size_t size)
+	{
+		if (!workers || workers->size() != size) {
+			workers.reset();
+			workers = std::unique_ptr<libaction::detail::WorkerPool>(
+				new libaction::detail::WorkerPool(size));
+		}
 	}
 
-	template<typename StillEstimator, typename ImagePtr>
-	static inline auto estimate_still_pose_from_callback_on(
-		std::size_t pos, bool last_image_access,
+	// Run the tasks in concurrency on the workers, one per still estimator,
+	// and on the prefetch threads if any.
+	template<typename StillEstimator, typename ZoomStillEstimator,
+		typename ImagePtr>
+	void concurrent_run(
+		std::size_t length, bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
+		const std::vector<StillEstimator*> &still_estimators,
+		const std::vector<ZoomStillEstimator*> &zoom_still_estimators,
 		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
 			&callback,
-		StillEstimator &still_estimator,
-		std::unordered_map<std::size_t, std::unique_ptr<libaction::Human>> &poses)
-	-> std::pair<ImagePtr, std::remove_reference<decltype(poses)>::type::iterator>
+		Concurrency<ImagePtr> &concurrency)
 	{
-		auto image = get_image_from_callback(pos, last_image_access, callback);
+		start_workers(still_estimators.size());
+
+		if (prefetch_threads != 0) {
+			if (!prefetch_workers ||
+					prefetch_workers->size() != prefetch_threads) {
+				prefetch_workers.reset();
+				prefetch_workers =
+					std::unique_ptr<libaction::detail::WorkerPool>(
+						new libaction::detail::WorkerPool(
+							prefetch_threads));
+			}
+
+			concurrency.prefetch_images = prefetch_images;
+			prefetch_workers->start([&] (std::size_t) {
+				concurrent_prefetch(zoom, zoom_rate, callback,
+					concurrency);
+			});
+		}
 
-		auto it = estimate_still_pose_from_image_on(pos, *image,
-			still_estimator, poses);
+		workers->start([&] (std::size_t worker) {
+			concurrent_preestimate(
+				length, zoom, zoom_range, zoom_rate,
+				*still_estimators[worker],
+				*zoom_still_estimators[worker],
+				callback, concurrency);
+		});
 
-		return std::make_pair(std::move(image), it);
+		workers->wait();
+		if (prefetch_threads != 0)
+			prefetch_workers->wait();
+
+		if (concurrency.error)
+			std::rethrow_exception(concurrency.error);
+	}
+
+	// Whether the image of a task is no longer needed after the task.
+	static inline bool last_image_access_of(const detail::TaskGraph::Task &task,
+		bool zoom, std::size_t zoom_rate)
+	{
+		return task.second || !needs_zoom(zoom, task.first, zoom_rate);
 	}
 
 	/// Try doing one task for concurrent(multithread) estimation. Returns
@@ -446,56 +1268,54 @@ private:
 		ZoomStillEstimator &zoom_still_estimator,
 		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
 			&callback,
-		std::list<std::pair<std::size_t, bool>> &queue,
-		std::list<std::pair<std::size_t, bool>> &extra_queue,
+		Concurrency<ImagePtr> &concurrency,
 		std::unique_lock<std::mutex> &lock)
 	{
-		std::size_t pos = 0;
-		bool zoomed = false;
-
-		// try to find the first possible task
-		bool found = false;
-		for (auto it = queue.begin(); it != queue.end(); it++) {
-			if (it->second) {
-				if (zoom_estimation_possible(it->first, length, zoom_range, zoom_rate)) {
-					std::tie(pos, zoomed) = *it;
-					found = true;
-					queue.erase(it);
-					break;
-				}
-			} else {
-				std::tie(pos, zoomed) = *it;
-				found = true;
-				queue.erase(it);
-				break;
+		auto &graph = concurrency.graph;
+
+		detail::TaskGraph::Task task;
+		std::shared_ptr<const ImagePtr> image;
+
+		// prefetched tasks are taken first
+		if (!concurrency.prefetched.empty()) {
+			task = concurrency.prefetched.front().first;
+			image = std::move(concurrency.prefetched.front().second);
+			concurrency.prefetched.pop_front();
+
+			// there is room for another prefetch
+			concurrency.cv.notify_all();
+		} else if (graph.pop(task)) {
+			if (image_needed(task)) {
+				image = get_image(task.first,
+					last_image_access_of(task, zoom, zoom_rate), callback,
+					&lock);
 			}
-		}
-		if (!found) {
-			for (auto it = extra_queue.begin(); it != extra_queue.end(); it++) {
-				if (it->second) {
-					if (zoom_estimation_possible(it->first, length, zoom_range, zoom_rate)) {
-						std::tie(pos, zoomed) = *it;
-						found = true;
-						extra_queue.erase(it);
-						break;
-					}
-				} else {
-					std::tie(pos, zoomed) = *it;
-					found = true;
-					extra_queue.erase(it);
-					break;
-				}
-			}
-		}
-		if (!found)
+		} else {
 			return std::make_pair(false, false);
+		}
+
+		std::size_t pos;
+		bool zoomed;
+		std::tie(pos, zoomed) = task;
 
 		if (zoomed) {
-			auto unzoomed_it = unzoomed_still_poses.find(pos);
-			if (unzoomed_it == unzoomed_still_poses.end())
+			if (!unzoomed_still_poses.contains(pos))
 				throw std::runtime_error("cannot find frame in unzoomed_still_poses");
+			auto unzoomed = unzoomed_still_poses.get(pos);
+
+			if (unzoomed && zoom_skipped(pos)) {
+				// zoom skipped by the zoom policy
 
-			if (unzoomed_it->second) {
+				images.erase(pos);
+
+				still_poses.insert(pos, std::unique_ptr<libaction::Human>(
+					new libaction::Human(*unzoomed)));
+				graph.finish(task);
+				skipped_zooms++;
+
+				// finished one task, but no work is done
+				return std::make_pair(true, false);
+			} else if (unzoomed) {
 				// human found in the unzoomed image
 
 				// now prepare the hints for a zoomed estimation
@@ -504,38 +1324,36 @@ private:
 				std::tie(l, r) = libaction::still::single::zoom::get_zoom_lr(
 					pos, length, zoom_range);
 
-				std::vector<const libaction::Human *> hints;
+				std::vector<pose_ptr> hints;
 
 				for (std::size_t i = l; i <= r; i++) {
-					if (i == pos)
+					if (i == pos || !known_keyframe(i))
 						continue;
 
-					decltype(still_poses)::iterator it;
+					pose_ptr hint;
 					if (needs_zoom(zoom, i, zoom_rate)) {
 						// unzoomed estimations for images which should be
 						// zoomed go to unzoomed_still_poses
 
-						it = unzoomed_still_poses.find(i);
-						if (it == unzoomed_still_poses.end())
+						if (!unzoomed_still_poses.contains(i))
 							throw std::runtime_error("cannot find frame in unzoomed_still_poses");
+						hint = unzoomed_still_poses.get(i);
 					} else {
 						// estimations for images which should not be zoomed
 						// go to still_poses
 
-						it = still_poses.find(i);
-						if (it == still_poses.end())
+						if (!still_poses.contains(i))
 							throw std::runtime_error("cannot find frame in still_poses");
+						hint = still_poses.get(i);
 					}
 
-					if (it->second)	// a useful hint
-						hints.push_back(it->second.get());
+					if (hint)	// a useful hint
+						hints.push_back(std::move(hint));
 				}
 
-				auto image = get_image_from_callback(pos, true, callback);
-
 				// zoom estimate
 				using zoom_cb_arg = boost::multi_array<typename
-					std::remove_reference<decltype(*image)>::type::element,
+					std::remove_reference<decltype(**image)>::type::element,
 					3
 				>;
 				std::function<std::unique_ptr<libaction::Human>
@@ -549,161 +1367,244 @@ private:
 							image_to_estimate, zoom_still_estimator);
 						lock.lock();
 						return result;
-					} catch (const std::runtime_error &) {
+					} catch (...) {
 						lock.lock();
 						throw;
 					}
 				};
 				auto human = libaction::still::single::zoom::zoom_estimate(
-					*image, *unzoomed_it->second, hints, zoom_cb);
+					**image, *unzoomed, hints, zoom_cb);
+				zooms++;
 
 				// zoomed estimations for images which should be zoomed go
 				// to still_poses
-				still_poses.insert(std::make_pair(pos, std::move(human)));
+				still_poses.insert(pos, std::move(human));
+				graph.finish(task);
 
 				return std::make_pair(true, true);
 			} else {
 				// no human found in unzoomed image
 				// impossible to do zoomed estimation
 
-				// a little bit wasteful, but we need to inform callback that
-				// the image at pos is no longer needed
-				get_image_from_callback(pos, true, callback);
+				images.erase(pos);
 
-				still_poses.insert(std::make_pair(pos, std::unique_ptr<libaction::Human>()));
+				still_poses.insert(pos, std::unique_ptr<libaction::Human>());
+				graph.finish(task);
 
 				// finished one task, but no work is done
 				return std::make_pair(true, false);
 			}
 		} else {
 			bool eventually_zoom = needs_zoom(zoom, pos, zoom_rate);
-			auto image = get_image_from_callback(pos, !eventually_zoom,
-				callback);
+
+			// the tasks tracked from or reused are finished
+			auto base_pose_of = [this, zoom, zoom_rate] (std::size_t frame) {
+				auto &poses = (needs_zoom(zoom, frame, zoom_rate) ?
+					unzoomed_still_poses : still_poses);
+				if (!poses.contains(frame))
+					throw std::runtime_error("cannot find frame required");
+				return poses.get(frame);
+			};
+
+			auto frames = tracked_frames(pos);
+			std::vector<pose_ptr> tracked_poses;
+			for (auto frame: frames)
+				tracked_poses.push_back(base_pose_of(frame));
+			detail::Region region;
+			bool has_region = track_region(pos, frames, tracked_poses, region);
+
+			pose_ptr previous;
+			std::shared_ptr<const std::vector<float>> previous_reference;
+			for (auto frame: reused_frames_of(pos)) {
+				previous = base_pose_of(frame);
+				previous_reference = reference_of(frame);
+			}
 
 			std::unique_ptr<libaction::Human> human;
+			std::shared_ptr<const std::vector<float>> reference;
 
 			// unlock and estimate
 			lock.unlock();
 			try {
-				human = estimate_still_pose_from_image(*image, still_estimator);
+				human = estimate_base_pose(**image,
+					has_region ? &region : nullptr, previous_reference,
+					previous.get(), still_estimator, reference);
 				lock.lock();
-			} catch (const std::runtime_error &) {
+			} catch (...) {
 				lock.lock();
 				throw;
 			}
 
 			(eventually_zoom ? unzoomed_still_poses : still_poses)
-				.insert(std::make_pair(pos, std::move(human)));
+				.insert(pos, std::move(human));
+			if (reference)
+				references[pos] = std::move(reference);
+			graph.finish(task);
 
 			return std::make_pair(true, true);
 		}
 	}
 
-	// Do tasks until one unit of work is done for concurrent(multithread)
-	// estimation.
+	// Do tasks for concurrent(multithread) estimation until all primary
+	// tasks are taken and all prefetched tasks are done. Each worker takes
+	// the next task as soon as it finishes one, and waits only if every
+	// remaining task depends on a running or prefetching one.
 	template<typename StillEstimator, typename ZoomStillEstimator,
 		typename ImagePtr>
-	void concurrent_preestimate_one_ensure_work(
+	void concurrent_preestimate_loop(
 		std::size_t length, bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
 		StillEstimator &still_estimator,
 		ZoomStillEstimator &zoom_still_estimator,
 		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
 			&callback,
-		std::list<std::pair<std::size_t, bool>> &queue,
-		std::list<std::pair<std::size_t, bool>> &extra_queue,
-		std::unique_lock<std::mutex> &lock)
+		Concurrency<ImagePtr> &concurrency)
 	{
-		while (true) {
-			auto result = concurrent_preestimate_try_one(length,
-				zoom, zoom_range, zoom_rate,
-				still_estimator, zoom_still_estimator, callback,
-				queue, extra_queue, lock);
+		std::unique_lock<std::mutex> lock(concurrency.mutex);
+
+		while (!concurrency.failed && (!concurrency.graph.empty() ||
+				!concurrency.prefetched.empty() ||
+				concurrency.prefetching != 0)) {
+			check_cancelled();
 
-			// bail out if either some work is done or no task is available
-			if (result.second || !result.first)
+			std::pair<bool, bool> result;
+
+			concurrency.running_tasks++;
+			try {
+				result = concurrent_preestimate_try_one(length,
+					zoom, zoom_range, zoom_rate,
+					still_estimator, zoom_still_estimator, callback,
+					concurrency, lock);
+			} catch (...) {
+				concurrency.running_tasks--;
+				throw;
+			}
+			concurrency.running_tasks--;
+
+			if (result.first) {
+				// a finished task may make zoomed tasks possible
+				concurrency.cv.notify_all();
+				continue;
+			}
+
+			// no task is possible, and no running task can make one possible
+			if (concurrency.running_tasks == 0 &&
+					concurrency.prefetching == 0)
 				break;
+
+			concurrency.cv.wait(lock);
 		}
+
+		// wake up threads waiting for this one
+		concurrency.cv.notify_all();
 	}
 
 	template<typename StillEstimator, typename ZoomStillEstimator,
 		typename ImagePtr>
-	void concurrent_preestimate_loop(
+	void concurrent_preestimate(
 		std::size_t length, bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
 		StillEstimator &still_estimator,
 		ZoomStillEstimator &zoom_still_estimator,
 		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
 			&callback,
-		std::list<std::pair<std::size_t, bool>> &queue,
-		std::list<std::pair<std::size_t, bool>> &extra_queue,
-		std::mutex &mutex,
-		std::condition_variable &cv,
-		bool &status, bool &end)
+		Concurrency<ImagePtr> &concurrency)
 	{
-		while (true) {
-			// status is false
+		try {
+			concurrent_preestimate_loop(length, zoom, zoom_range, zoom_rate,
+				still_estimator, zoom_still_estimator,
+				callback, concurrency);
+		} catch (...) {
+			concurrent_fail(concurrency);
+		}
+	}
 
-			{
-				std::unique_lock<std::mutex> lock(mutex);
+	// Fetch images of ready tasks ahead of the estimation threads. A task
+	// taken here is always done by an estimation thread.
+	template<typename ImagePtr>
+	void concurrent_prefetch_loop(
+		bool zoom, std::size_t zoom_rate,
+		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+			&callback,
+		Concurrency<ImagePtr> &concurrency)
+	{
+		std::unique_lock<std::mutex> lock(concurrency.mutex);
 
-				concurrent_preestimate_one_ensure_work(
-					length, zoom, zoom_range, zoom_rate,
-					still_estimator, zoom_still_estimator, callback,
-					queue, extra_queue, lock
-				);
+		while (!concurrency.failed && !concurrency.graph.empty()) {
+			check_cancelled();
 
-				status = true;
+			if (concurrency.prefetched.size() + concurrency.prefetching >=
+					concurrency.prefetch_images) {
+				concurrency.cv.wait(lock);
+				continue;
 			}
 
-			// status is true
-
-			cv.notify_all();
+			detail::TaskGraph::Task task;
+			if (!concurrency.graph.pop(task)) {
+				// nothing is ready, and nothing can become ready
+				if (concurrency.running_tasks == 0 &&
+						concurrency.prefetching == 0 &&
+						concurrency.prefetched.empty())
+					break;
 
-			{
-				std::unique_lock<std::mutex> lock(mutex);
+				concurrency.cv.wait(lock);
+				continue;
+			}
 
-				cv.wait(lock, [&status] { return !status; });
-				if (end)
-					return;
+			concurrency.prefetching++;
+			std::shared_ptr<const ImagePtr> image;
+			try {
+				if (image_needed(task)) {
+					image = get_image(task.first,
+						last_image_access_of(task, zoom, zoom_rate), callback,
+						&lock);
+				}
+			} catch (...) {
+				concurrency.prefetching--;
+				throw;
 			}
+			concurrency.prefetching--;
 
-			// status is false
+			concurrency.prefetched.push_back(
+				std::make_pair(task, std::move(image)));
+			concurrency.cv.notify_all();
 		}
+
+		// wake up threads waiting for this one
+		concurrency.cv.notify_all();
 	}
 
-	template<typename StillEstimator, typename ZoomStillEstimator,
-		typename ImagePtr>
-	void concurrent_preestimate(
-		std::size_t length, bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
-		StillEstimator &still_estimator,
-		ZoomStillEstimator &zoom_still_estimator,
+	template<typename ImagePtr>
+	void concurrent_prefetch(
+		bool zoom, std::size_t zoom_rate,
 		const std::function<ImagePtr(std::size_t pos, bool last_image_access)>
 			&callback,
-		std::list<std::pair<std::size_t, bool>> &queue,
-		std::list<std::pair<std::size_t, bool>> &extra_queue,
-		std::mutex &mutex,
-		std::condition_variable &cv,
-		bool &status, bool &end)
+		Concurrency<ImagePtr> &concurrency)
 	{
 		try {
-			concurrent_preestimate_loop(length, zoom, zoom_range, zoom_rate,
-				still_estimator, zoom_still_estimator,
-				callback, queue, extra_queue,
-				mutex, cv, status, end);
+			concurrent_prefetch_loop(zoom, zoom_rate, callback, concurrency);
 		} catch (...) {
-			{
-				std::unique_lock<std::mutex> lock(mutex);
+			concurrent_fail(concurrency);
+		}
+	}
 
-				queue.clear();
-				extra_queue.clear();
+	// Stop concurrent estimation after an error, which must be the current
+	// exception. The first error is rethrown by concurrent_run().
+	template<typename ImagePtr>
+	static void concurrent_fail(Concurrency<ImagePtr> &concurrency)
+	{
+		{
+			std::unique_lock<std::mutex> lock(concurrency.mutex);
 
-				status = true;
-			}
-			cv.notify_all();
+			if (!concurrency.failed)
+				concurrency.error = std::current_exception();
+			concurrency.failed = true;
+			concurrency.graph.clear();
+			concurrency.prefetched.clear();
 		}
+		concurrency.cv.notify_all();
 	}
 
 	template<typename StillEstimator, typename ImagePtr>
-	std::pair<bool, const libaction::Human *>
+	std::pair<bool, pose_ptr>
 	fuzz_callback_before_anti_crossing(std::size_t pos, std::size_t length,
 		bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
 		StillEstimator &still_estimator,
@@ -713,46 +1614,57 @@ private:
 		std::size_t offset, bool left)
 	{
 		if (pos >= length)
-			return std::make_pair(false, nullptr);
+			return std::make_pair(false, pose_ptr());
 
 		// get the real pos
 		if (left) {
 			if (offset > pos)
-				return std::make_pair(false, nullptr);
+				return std::make_pair(false, pose_ptr());
 			else
 				pos -= offset;
 		} else {
 			if (offset >= length - pos)
-				return std::make_pair(false, nullptr);
+				return std::make_pair(false, pose_ptr());
 			else
 				pos += offset;
 		}
 
-		{
-			// Does pos already exist in still_poses?
-			auto it = still_poses.find(pos);
-			if (it != still_poses.end())
-				return std::make_pair(true, it->second.get());
-		}
+		// Does pos already exist in still_poses?
+		if (still_poses.contains(pos))
+			return std::make_pair(true, still_poses.get(pos));
 
 		// single-thread support
 
 		// pos does not exist in still_poses. We need to estimate it.
+		check_cancelled();
+
+		decide_keyframes(pos, zoom, zoom_rate, still_estimator, callback);
+		if (!known_keyframe(pos)) {
+			// not a keyframe, left to fuzz estimation
+			still_poses.insert(pos, std::unique_ptr<libaction::Human>());
+			non_keyframes++;
+
+			return std::make_pair(true, pose_ptr());
+		}
 
 		if (needs_zoom(zoom, pos, zoom_rate)) {
 			// the image at pos needs to be zoomed
 
 			// make sure that pos exists in unzoomed_still_poses
-			auto unzoomed_it = unzoomed_still_poses.find(pos);
-			if (unzoomed_it == unzoomed_still_poses.end()) {
-				std::tie(std::ignore, unzoomed_it) =
-					estimate_still_pose_from_callback_on(
-						pos, false, callback, still_estimator,
-						unzoomed_still_poses
-					);
-			}
+			auto unzoomed = base_pose(pos, zoom, zoom_rate, still_estimator,
+				callback);
+
+			if (unzoomed && zoom_skipped(pos)) {
+				// zoom skipped by the zoom policy
 
-			if (unzoomed_it->second) {
+				images.erase(pos);
+
+				still_poses.insert(pos, std::unique_ptr<libaction::Human>(
+					new libaction::Human(*unzoomed)));
+				skipped_zooms++;
+
+				return std::make_pair(true, still_poses.get(pos));
+			} else if (unzoomed) {
 				// human found in the unzoomed image
 
 				// now prepare the hints for a zoomed estimation
@@ -761,47 +1673,34 @@ private:
 				std::tie(l, r) = libaction::still::single::zoom::get_zoom_lr(
 					pos, length, zoom_range);
 
-				std::vector<const libaction::Human *> hints;
+				std::vector<pose_ptr> hints;
 
 				// make all unzoomed estimations available within zoom_range
 				for (std::size_t i = l; i <= r; i++) {
 					if (i == pos)
 						continue;
 
-					decltype(still_poses)::iterator it;
-					if (needs_zoom(zoom, i, zoom_rate)) {
-						// unzoomed estimations for images which should be
-						// zoomed go to unzoomed_still_poses
-
-						it = unzoomed_still_poses.find(i);
-						if (it == unzoomed_still_poses.end()) {
-							it = estimate_still_pose_from_callback_on(
-								i, false, callback, still_estimator,
-								unzoomed_still_poses
-							).second;
-						}
-					} else {
-						// estimations for images which should not be zoomed
-						// go to still_poses
+					// frames other than keyframes give no hint
+					decide_keyframes(i, zoom, zoom_rate, still_estimator,
+						callback);
+					if (!known_keyframe(i))
+						continue;
 
-						it = still_poses.find(i);
-						if (it == still_poses.end()) {
-							it = estimate_still_pose_from_callback_on(
-								i, true, callback, still_estimator,
-								still_poses
-							).second;
-						}
-					}
+					// unzoomed estimations for images which should be
+					// zoomed go to unzoomed_still_poses, and estimations for
+					// images which should not be zoomed go to still_poses
+					auto hint = base_pose(i, zoom, zoom_rate,
+						still_estimator, callback);
 
-					if (it->second)	// a useful hint
-						hints.push_back(it->second.get());
+					if (hint)	// a useful hint
+						hints.push_back(std::move(hint));
 				}
 
-				auto image = get_image_from_callback(pos, true, callback);
+				auto image = get_image(pos, true, callback);
 
 				// zoom estimate
 				using zoom_cb_arg = boost::multi_array<typename
-					std::remove_reference<decltype(*image)>::type::element,
+					std::remove_reference<decltype(**image)>::type::element,
 					3
 				>;
 				std::function<std::unique_ptr<libaction::Human>
@@ -811,33 +1710,32 @@ private:
 						zoom_still_estimator);
 				};
 				auto human = libaction::still::single::zoom::zoom_estimate(
-					*image, *unzoomed_it->second, hints, zoom_cb);
+					**image, *unzoomed, hints, zoom_cb);
+				zooms++;
 
 				// zoomed estimations for images which should be zoomed go
 				// to still_poses
-				auto it = still_poses.insert(
-					std::make_pair(pos, std::move(human))).first;
+				still_poses.insert(pos, std::move(human));
 
-				return std::make_pair(true, it->second.get());
+				return std::make_pair(true, still_poses.get(pos));
 			} else {
 				// no human found in unzoomed image
 				// impossible to do zoomed estimation
 
-				// a little bit wasteful, but we need to inform callback that
 				// the image at pos is no longer needed
-				get_image_from_callback(pos, true, callback);
+				images.erase(pos);
 
-				still_poses.insert(std::make_pair(pos, std::unique_ptr<libaction::Human>()));
+				still_poses.insert(pos, std::unique_ptr<libaction::Human>());
 
-				return std::make_pair(true, nullptr);
+				return std::make_pair(true, pose_ptr());
 			}
 		} else {
 			// the image at pos does not need to be zoomed
 
-			auto it = estimate_still_pose_from_callback_on(
-				pos, true, callback, still_estimator, still_poses).second;
+			auto human = base_pose(pos, zoom, zoom_rate, still_estimator,
+				callback);
 
-			return std::make_pair(true, it->second.get());
+			return std::make_pair(true, std::move(human));
 		}
 	}
 
@@ -862,7 +1760,7 @@ private:
 			offset, left);
 
 		if (anti_crossing && result.first && result.second) {
-			std::pair<bool, const libaction::Human *> left_human, right_human;
+			std::pair<bool, pose_ptr> left_human, right_human;
 			{
 				// left
 				std::size_t offset2 = offset;
@@ -903,12 +1801,13 @@ private:
 			}
 
 			if (!left_human.first)
-				left_human.second = nullptr;
+				left_human.second.reset();
 			if (!right_human.first)
-				right_human.second = nullptr;
+				right_human.second.reset();
 
 			auto anti_crossing_result = anti_crossing::anti_crossing(
-				*result.second, left_human.second, right_human.second);
+				*result.second, left_human.second.get(),
+				right_human.second.get());
 
 			std::unique_ptr<const libaction::Human,
 				std::function<void(const libaction::Human *)>> human_ptr(
@@ -918,20 +1817,14 @@ private:
 			return std::make_pair(true, std::move(human_ptr));
 		}
 
-		std::unique_ptr<const libaction::Human,
-			std::function<void(const libaction::Human *)>> human_ptr;
-		if (result.first && result.second) {
-			human_ptr = std::unique_ptr<const libaction::Human,
-				std::function<void(const libaction::Human *)>>(
-					result.second,
-					[] (const libaction::Human *) {});
-		}
-
-		return std::make_pair(result.first, std::move(human_ptr));
+		return std::make_pair(result.first, std::move(result.second));
 	}
 
+	// Get the still pose at the frame located by offset and left, after
+	// anti crossing and max_lengths. The result is kept in processed_poses,
+	// and borrowed until the pose is evicted.
 	template<typename StillEstimator, typename ImagePtr>
-	std::pair<bool, std::unique_ptr<const libaction::Human>>
+	std::pair<bool, const libaction::Human *>
 	fuzz_callback(std::size_t pos, std::size_t length,
 		const std::vector<std::tuple<
 			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
@@ -944,37 +1837,54 @@ private:
 			&callback,
 		std::size_t offset, bool left)
 	{
+		if (pos >= length)
+			return std::make_pair(false, nullptr);
+
+		// get the real pos
+		if (left) {
+			if (offset > pos)
+				return std::make_pair(false, nullptr);
+			else
+				pos -= offset;
+		} else {
+			if (offset >= length - pos)
+				return std::make_pair(false, nullptr);
+			else
+				pos += offset;
+		}
+
+		if (processed_poses.contains(pos))
+			return std::make_pair(true, processed_poses.borrow(pos));
+
 		auto result = fuzz_callback_before_max_lengths(pos, length,
 			anti_crossing,
 			zoom, zoom_range, zoom_rate,
 			still_estimator, zoom_still_estimator, callback,
-			offset, left);
+			0, false);
 
-		std::pair<bool, std::unique_ptr<libaction::Human>> ret{};
-		ret.first = result.first;
-		if (result.first && result.second) {
-			ret.second = std::unique_ptr<libaction::Human>(
+		std::unique_ptr<libaction::Human> human;
+		if (result.second) {
+			human = std::unique_ptr<libaction::Human>(
 				new libaction::Human(*result.second));
-		}
 
-		if (ret.first && ret.second) {
 			for (auto &arg: max_lengths) {
-				auto from = ret.second->body_parts().find(std::get<0>(arg));
-				if (from == ret.second->body_parts().end())
+				auto from = human->body_parts().find(std::get<0>(arg));
+				if (from == human->body_parts().end())
 					continue;
-				auto to = ret.second->body_parts().find(std::get<1>(arg));
-				if (to == ret.second->body_parts().end())
+				auto to = human->body_parts().find(std::get<1>(arg));
+				if (to == human->body_parts().end())
 					continue;
 
 				if (std::sqrt((from->second.x() - to->second.x()) * (from->second.x() - to->second.x())
 						+ (from->second.y() - to->second.y()) * (from->second.y() - to->second.y()))
 						> std::get<2>(arg)) {
-					ret.second->body_parts().erase(to);
+					human->body_parts().erase(to);
 				}
 			}
 		}
 
-		return std::move(ret);
+		processed_poses.insert(pos, std::move(human));
+		return std::make_pair(true, processed_poses.borrow(pos));
 	}
 
 	/// Get the processed human pose to return to the user.
@@ -992,6 +1902,10 @@ private:
 	}
 };
 
+/// Single-person motion estimator, with still poses packed if
+/// LIBACTION_PACKED_POSE_CACHE is defined.
+using Estimator = BasicEstimator<>;
+
 }
 }
 }
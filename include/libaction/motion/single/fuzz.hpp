@@ -10,13 +10,16 @@
 
 #include "../../body_part.hpp"
 #include "../../human.hpp"
+#include "../../skeleton.hpp"
 #include "fuzz/detail.hpp"
 
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <queue>
 #include <stdexcept>
 #include <tuple>
 #include <utility>
@@ -69,6 +72,12 @@ get_fuzz_lr(std::size_t pos, std::size_t length, std::size_t fuzz_range)
 
 /// Fuzz estimation for a single person.
 
+/// @tparam     Callback    A callable of signature
+///                         `std::pair<bool, HumanPtr>(std::size_t relative_pos,
+///                         bool left)`, where `HumanPtr` is any pointer-like
+///                         type to libaction::Human, such as a borrowed
+///                         `const libaction::Human *`.
+/// @tparam     Skeleton    The skeleton whose rules are used for estimation.
 /// @param[in]  fuzz_range  The range of images used for fuzz estimation.
 ///                         The distance between the right frame and the left
 ///                         frame used in each recipe is at most `fuzz_range`.
@@ -86,19 +95,22 @@ get_fuzz_lr(std::size_t pos, std::size_t length, std::size_t fuzz_range)
 ///                         used when the first value is true, in which case
 ///                         the second value should be a human estimation, or
 ///                         `nullptr` if the person does not exist at the
-///                         location. The callback may be called multiple times
-///                         with the same arguments, so you should consider
-///                         caching the results, at least for all frames within
-///                         the range returned by get_fuzz_lr().
+///                         location. The callback is called at most once
+///                         for each frame, in the order of increasing
+///                         `relative_pos` on each side, and only as far as
+///                         needed. The pointers returned are kept until this
+///                         function returns, so borrowed humans must remain
+///                         valid until then.
 /// @warning                The person must exist at the target frame.
 /// @return                 A human inferred from the image.
 /// @exception              std::runtime_error
-template<typename HumanPtr>
+template<typename Callback, typename Skeleton = libaction::skeleton::Coco18>
 inline std::unique_ptr<libaction::Human> fuzz(
 	std::size_t fuzz_range,
-	const std::function<std::pair<bool, HumanPtr>(std::size_t relative_pos, bool left)>
-		&callback)
+	const Callback &callback)
 {
+	using HumanPtr = typename detail::callback_human_ptr<Callback>::type;
+
 	std::unique_ptr<libaction::Human> target;
 
 	{
@@ -115,141 +127,185 @@ inline std::unique_ptr<libaction::Human> fuzz(
 		}
 	}
 
-	const auto &relative = detail::relative_recipe();
-	const auto &absolute = detail::absolute_recipe();
-
-	while (true) {
-		std::pair<
-			std::pair<std::size_t, std::size_t>,
-			std::pair<
-				libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex>
-		> relative_candidate;
-		std::pair<
-			std::pair<std::size_t, std::size_t>,
-			libaction::BodyPart::PartIndex
-		> absolute_candidate;
-
-		bool use_relative = false, use_absolute = false;
-		float score = -1.0f;
-
-		if (target) {
-			// relative recipe
-			for (auto &rule: relative) {
-				if (detail::has_part(*target, rule.second) ||
-						!detail::has_part(*target, rule.first))
-					continue;
-
-				std::vector<libaction::BodyPart::PartIndex> search_for{
-					rule.first, rule.second };
-				auto search_result = detail::search_for_parts(fuzz_range, search_for, callback);
-				if (search_result.first == 0)	// not found
-					continue;
-
-				auto left = callback(search_result.first, true).second;
-				auto right = callback(search_result.second, false).second;
-
-				auto current_score = detail::get_relative_fuzz_score(
-					search_result.first,
-					search_result.second,
-					*left,
-					*right,
-					*target,
-					rule.first,
-					rule.second
-				);
-				if (current_score > score) {
-					score = current_score;
-					use_relative = true;
-					relative_candidate = std::make_pair(
-						std::make_pair(search_result.first, search_result.second),
-						rule
-					);
-				}
+	detail::PresenceIndex<HumanPtr, Callback> index(callback);
+
+	// The best candidate is applied at a time, which is the one with the
+	// highest score, and the first one among equal scores. Relative rules
+	// are preferred to absolute ones. The score of a rule never changes, so
+	// candidates are only added when their rules become applicable, and
+	// dropped when their target parts are found.
+	std::priority_queue<detail::Candidate, std::vector<detail::Candidate>,
+		detail::CandidateLess> relative_candidates, absolute_candidates;
+	bool absolute_searched = false;
+
+	constexpr std::size_t relative_rules_size =
+		sizeof(Skeleton::relative_rules) / sizeof(*Skeleton::relative_rules);
+	constexpr std::size_t absolute_rules_size =
+		sizeof(Skeleton::absolute_rules) / sizeof(*Skeleton::absolute_rules);
+
+	// add candidates of the relative rules from `part`
+	auto add_relative_candidates = [&] (libaction::BodyPart::PartIndex part) {
+		for (std::size_t i = 0; i < relative_rules_size; i++) {
+			auto &rule = Skeleton::relative_rules[i];
+			if (rule.first != part || detail::has_part(*target, rule.second))
+				continue;
+
+			auto search_result = detail::search_for_parts(fuzz_range,
+				libaction::skeleton::mask(rule.first) |
+					libaction::skeleton::mask(rule.second),
+				index);
+			if (search_result.first == 0)	// not found
+				continue;
+
+			auto &left = index.human(search_result.first, true);
+			auto &right = index.human(search_result.second, false);
+
+			auto score = detail::get_relative_fuzz_score(
+				search_result.first,
+				search_result.second,
+				*left,
+				*right,
+				*target,
+				rule.first,
+				rule.second
+			);
+			if (score > -1.0f) {
+				relative_candidates.push(detail::Candidate{
+					score, i, search_result.first, search_result.second });
 			}
 		}
-
-		if (!use_relative) {
-			// absolute recipe
-			for (auto &rule: absolute) {
-				if (target && detail::has_part(*target, rule))
-					continue;
-
-				auto search_result = detail::search_for_parts(fuzz_range, { rule }, callback);
-				if (search_result.first == 0)	// not found
-					continue;
-
-				auto left = callback(search_result.first, true).second;
-				auto right = callback(search_result.second, false).second;
-
-				auto current_score = detail::get_absolute_fuzz_score(
-					search_result.first,
-					search_result.second,
-					*left,
-					*right,
-					rule
-				);
-				if (current_score > score) {
-					score = current_score;
-					use_relative = false;
-					use_absolute = true;
-					absolute_candidate = std::make_pair(
-						std::make_pair(search_result.first, search_result.second),
-						rule
-					);
-				}
+	};
+
+	// add candidates of the absolute rules
+	auto add_absolute_candidates = [&] () {
+		for (std::size_t i = 0; i < absolute_rules_size; i++) {
+			auto &rule = Skeleton::absolute_rules[i];
+			if (target && detail::has_part(*target, rule))
+				continue;
+
+			auto search_result = detail::search_for_parts(fuzz_range,
+				libaction::skeleton::mask(rule), index);
+			if (search_result.first == 0)	// not found
+				continue;
+
+			auto &left = index.human(search_result.first, true);
+			auto &right = index.human(search_result.second, false);
+
+			auto score = detail::get_absolute_fuzz_score(
+				search_result.first,
+				search_result.second,
+				*left,
+				*right,
+				rule
+			);
+			if (score > -1.0f) {
+				absolute_candidates.push(detail::Candidate{
+					score, i, search_result.first, search_result.second });
 			}
 		}
+	};
+
+	if (target) {
+		for (auto &part: target->body_parts())
+			add_relative_candidates(part.first);
+	}
 
-		if (target && use_relative) {
-			auto &pos = relative_candidate.first;
-			auto &rule = relative_candidate.second;
+	while (true) {
+		// relative recipe
+		while (!relative_candidates.empty() && detail::has_part(*target,
+				Skeleton::relative_rules[
+					relative_candidates.top().rule].second))
+			relative_candidates.pop();
+
+		if (!relative_candidates.empty()) {
+			auto candidate = relative_candidates.top();
+			relative_candidates.pop();
+			auto &rule = Skeleton::relative_rules[candidate.rule];
 
-			auto left = callback(pos.first, true).second;
-			auto right = callback(pos.second, false).second;
+			auto &left = index.human(candidate.left_offset, true);
+			auto &right = index.human(candidate.right_offset, false);
 
 			auto body_part = detail::get_relative_fuzz_part(
-				pos.first,
-				pos.second,
+				candidate.left_offset,
+				candidate.right_offset,
 				*left,
 				*right,
 				*target,
 				rule.first,
 				rule.second,
-				score
+				candidate.score
 			);
 
 			target->body_parts()[rule.second] = body_part;
-		} else if (use_absolute) {
-			auto &pos = absolute_candidate.first;
-			auto &rule = absolute_candidate.second;
+			add_relative_candidates(rule.second);
+			continue;
+		}
 
-			auto left = callback(pos.first, true).second;
-			auto right = callback(pos.second, false).second;
+		// absolute recipe
+		if (!absolute_searched) {
+			add_absolute_candidates();
+			absolute_searched = true;
+		}
 
-			auto body_part = detail::get_absolute_fuzz_part(
-				pos.first,
-				pos.second,
-				*left,
-				*right,
-				rule,
-				score
-			);
+		while (!absolute_candidates.empty() && target && detail::has_part(
+				*target,
+				Skeleton::absolute_rules[absolute_candidates.top().rule]))
+			absolute_candidates.pop();
 
-			if (target) {
-				target->body_parts()[rule] = body_part;
-			} else {
-				target = std::unique_ptr<libaction::Human>(
-					new libaction::Human(std::vector<libaction::BodyPart>{
-						body_part }));
-			}
-		} else {
+		if (absolute_candidates.empty())
 			break;
+
+		auto candidate = absolute_candidates.top();
+		absolute_candidates.pop();
+		auto &rule = Skeleton::absolute_rules[candidate.rule];
+
+		auto &left = index.human(candidate.left_offset, true);
+		auto &right = index.human(candidate.right_offset, false);
+
+		auto body_part = detail::get_absolute_fuzz_part(
+			candidate.left_offset,
+			candidate.right_offset,
+			*left,
+			*right,
+			rule,
+			candidate.score
+		);
+
+		if (target) {
+			target->body_parts()[rule] = body_part;
+		} else {
+			target = std::unique_ptr<libaction::Human>(
+				new libaction::Human(std::vector<libaction::BodyPart>{
+					body_part }));
 		}
+		add_relative_candidates(rule);
 	}
 
 	return target;
 }
 
+/// Fuzz estimation for a single person, with a `std::function` callback.
+
+/// This overload allows `HumanPtr` to be given explicitly, as in
+/// `fuzz<std::unique_ptr<libaction::Human>>(fuzz_range, callback)`.
+///
+/// @tparam     HumanPtr    Any pointer-like type to libaction::Human.
+/// @tparam     Skeleton    The skeleton whose rules are used for estimation.
+/// @param[in]  fuzz_range  See the overload above.
+/// @param[in]  callback    See the overload above.
+/// @warning                The person must exist at the target frame.
+/// @return                 A human inferred from the image.
+/// @exception              std::runtime_error
+template<typename HumanPtr, typename Skeleton = libaction::skeleton::Coco18>
+inline std::unique_ptr<libaction::Human> fuzz(
+	std::size_t fuzz_range,
+	const std::function<std::pair<bool, HumanPtr>(
+		std::size_t relative_pos, bool left)> &callback)
+{
+	return fuzz<std::function<std::pair<bool, HumanPtr>(std::size_t, bool)>,
+		Skeleton>(fuzz_range, callback);
+}
+
 }
 }
 }
@@ -14,10 +14,12 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <stdexcept>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -32,181 +34,172 @@ namespace fuzz
 namespace detail
 {
 
-inline const std::vector<std::pair<
-	libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex>> &
-relative_recipe()
-{
-	using id = libaction::BodyPart::PartIndex;
-
-	// avoid the id:: prefix
-	auto nose = id::nose;
-	auto neck = id::neck;
-	auto shoulder_r = id::shoulder_r;
-	auto elbow_r = id::elbow_r;
-	auto wrist_r = id::wrist_r;
-	auto shoulder_l = id::shoulder_l;
-	auto elbow_l = id::elbow_l;
-	auto wrist_l = id::wrist_l;
-	auto hip_r = id::hip_r;
-	auto knee_r = id::knee_r;
-	auto ankle_r = id::ankle_r;
-	auto hip_l = id::hip_l;
-	auto knee_l = id::knee_l;
-	auto ankle_l = id::ankle_l;
-	auto eye_r = id::eye_r;
-	auto eye_l = id::eye_l;
-	auto ear_r = id::ear_r;
-	auto ear_l = id::ear_l;
-
-	static const std::vector<std::pair<
-		libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex
-	>> recipe{
-		// same name
-		{ eye_r, eye_l },
-		{ eye_l, eye_r },
-		{ shoulder_r, shoulder_l },
-		{ shoulder_l, shoulder_r },
-		{ ear_r, ear_l },
-		{ ear_l, ear_r },
-		{ hip_r, hip_l },
-		{ hip_l, hip_r },
-		// same side / both no side
-		{ eye_r, ear_r },
-		{ eye_l, ear_l },
-		{ knee_r, ankle_r },
-		{ knee_l, ankle_l },
-		{ shoulder_r, hip_r },
-		{ shoulder_l, hip_l },
-		{ hip_r, knee_r },
-		{ hip_l, knee_l },
-		{ knee_r, hip_r },
-		{ knee_l, hip_l },
-		{ hip_r, shoulder_r },
-		{ hip_l, shoulder_l },
-		{ ankle_r, knee_r },
-		{ ankle_l, knee_l },
-		{ ear_r, eye_r },
-		{ ear_l, eye_l },
-		{ shoulder_r, elbow_r },
-		{ shoulder_l, elbow_l },
-		{ elbow_r, shoulder_r },
-		{ elbow_l, shoulder_l },
-		{ nose, neck },
-		{ neck, nose },
-		{ elbow_r, wrist_r },
-		{ elbow_l, wrist_l },
-		{ wrist_r, elbow_r },
-		{ wrist_l, elbow_l },
-		// side -> no side
-		{ eye_r, nose },
-		{ eye_l, nose },
-		{ ear_r, nose },
-		{ ear_l, nose },
-		{ shoulder_r, neck },
-		{ shoulder_l, neck },
-		{ eye_r, neck },
-		{ eye_l, neck },
-		{ ear_r, neck },
-		{ ear_l, neck },
-		{ hip_r, neck },
-		{ hip_l, neck },
-		// no side -> side
-		{ neck, shoulder_r },
-		{ neck, shoulder_l },
-		{ nose, ear_r },
-		{ nose, ear_l },
-		{ nose, eye_r },
-		{ nose, eye_l },
-		{ neck, ear_r },
-		{ neck, ear_l },
-		{ neck, eye_r },
-		{ neck, eye_l },
-		// different sides
-		{ eye_r, ear_l },
-		{ eye_l, ear_r },
-		{ shoulder_r, hip_l },
-		{ shoulder_l, hip_r },
-		{ hip_r, shoulder_l },
-		{ hip_l, shoulder_r },
-		{ ear_r, eye_l },
-		{ ear_l, eye_r }
-	};
-
-	return recipe;
-}
-
-inline const std::vector<libaction::BodyPart::PartIndex> &
-absolute_recipe()
-{
-	using id = libaction::BodyPart::PartIndex;
-
-	// avoid the id:: prefix
-	auto nose = id::nose;
-	auto neck = id::neck;
-	auto shoulder_r = id::shoulder_r;
-	auto elbow_r = id::elbow_r;
-	auto wrist_r = id::wrist_r;
-	auto shoulder_l = id::shoulder_l;
-	auto elbow_l = id::elbow_l;
-	auto wrist_l = id::wrist_l;
-	auto hip_r = id::hip_r;
-	auto knee_r = id::knee_r;
-	auto ankle_r = id::ankle_r;
-	auto hip_l = id::hip_l;
-	auto knee_l = id::knee_l;
-	auto ankle_l = id::ankle_l;
-	auto eye_r = id::eye_r;
-	auto eye_l = id::eye_l;
-	auto ear_r = id::ear_r;
-	auto ear_l = id::ear_l;
-
-	static const std::vector<libaction::BodyPart::PartIndex> recipe{
-		ankle_r,
-		ankle_l,
-		neck,
-		shoulder_r,
-		shoulder_l,
-		hip_r,
-		hip_l,
-		knee_r,
-		knee_l,
-		nose,
-		eye_r,
-		eye_l,
-		ear_r,
-		ear_l,
-		elbow_r,
-		elbow_l,
-		wrist_r,
-		wrist_l
-	};
-
-	return recipe;
-}
-
 inline bool has_part(const libaction::Human &human,
 	libaction::BodyPart::PartIndex part_index)
 {
 	return human.body_parts().find(part_index) != human.body_parts().end();
 }
 
-inline bool has_parts(const libaction::Human &human,
-	const std::vector<libaction::BodyPart::PartIndex> &parts)
+inline bool has_parts(const libaction::Human &human, std::uint32_t parts)
 {
-	for (auto &part: parts) {
-		if (human.body_parts().find(part) == human.body_parts().end()) {
+	for (int i = 0; (parts >> i) != 0; i++) {
+		if ((parts & (static_cast<std::uint32_t>(1) << i)) == 0)
+			continue;
+		if (human.body_parts().find(static_cast<libaction::BodyPart::PartIndex>(i))
+				== human.body_parts().end()) {
 			return false;
 		}
 	}
 	return true;
 }
 
-template<typename HumanPtr>
+/// The pointer type to humans returned by a fuzz callback.
+template<typename Callback>
+struct callback_human_ptr
+{
+	using type = typename std::decay<decltype(std::declval<const Callback &>()(
+		std::size_t(), bool()).second)>::type;
+};
+
+inline int count_trailing_zeros(std::uint64_t bits)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(bits);
+#else
+	int count = 0;
+	for (; (bits & 1) == 0; bits >>= 1)
+		count++;
+	return count;
+#endif
+}
+
+/// Body parts present in the frames around the target frame.
+
+/// Frames are obtained from the callback lazily, in the order of increasing
+/// offsets, and never beyond the offsets a linear search would have reached.
+/// For each side, the offsets containing each body part are kept as a bitset,
+/// so that the nearest frame containing a set of parts is found with a few
+/// bit operations per 64 frames.
+template<typename HumanPtr, typename Callback>
+class PresenceIndex
+{
+public:
+	inline explicit PresenceIndex(const Callback &callback)
+	:
+	callback(callback)
+	{}
+
+	/// Find the nearest frame containing `parts`.
+
+	/// @param[in]  parts       The mask of the body parts.
+	/// @param[in]  left        The side to search.
+	/// @param[in]  max_offset  The maximum offset to search.
+	/// @return                 The offset of the frame, or 0 if not found.
+	inline std::size_t find(std::uint32_t parts, bool left,
+		std::size_t max_offset)
+	{
+		auto &side = sides[left ? 1 : 0];
+
+		std::size_t offset = side.find(parts,
+			std::min(max_offset, side.humans.size()));
+		if (offset != 0)
+			return offset;
+
+		while (side.humans.size() < max_offset && !side.bounded) {
+			if (!side.extend(callback, left))
+				break;
+			if (side.humans.back() &&
+					(side.masks.back() & parts) == parts)
+				return side.humans.size();
+		}
+
+		return 0;
+	}
+
+	/// The human at `offset`, which must have been searched.
+	inline const HumanPtr &human(std::size_t offset, bool left) const
+	{
+		return sides[left ? 1 : 0].humans.at(offset - 1);
+	}
+
+private:
+	struct Side
+	{
+		// humans at offsets from 1
+		std::vector<HumanPtr> humans{};
+		// parts present in humans
+		std::vector<std::uint32_t> masks{};
+		// offsets with a human, and offsets containing each part
+		std::vector<std::uint64_t> present{}, parts[32]{};
+		// whether the bound has been reached
+		bool bounded = false;
+
+		inline bool extend(const Callback &callback, bool left)
+		{
+			bool valid;
+			HumanPtr human;
+			std::tie(valid, human) = callback(humans.size() + 1, left);
+			if (!valid) {
+				bounded = true;
+				return false;
+			}
+
+			std::size_t bit = humans.size();
+			if (bit % 64 == 0) {
+				present.push_back(0);
+				for (auto &words: parts)
+					words.push_back(0);
+			}
+
+			std::uint32_t mask = 0;
+			if (human) {
+				present[bit / 64] |= static_cast<std::uint64_t>(1) << (bit % 64);
+				for (auto &part: human->body_parts()) {
+					auto index = static_cast<std::size_t>(part.first);
+					if (index >= 32)
+						continue;
+					mask |= static_cast<std::uint32_t>(1) << index;
+					parts[index][bit / 64] |=
+						static_cast<std::uint64_t>(1) << (bit % 64);
+				}
+			}
+
+			humans.push_back(std::move(human));
+			masks.push_back(mask);
+			return true;
+		}
+
+		// search offsets from 1 to max_offset, which must have been indexed
+		inline std::size_t find(std::uint32_t mask, std::size_t max_offset) const
+		{
+			for (std::size_t word = 0; word * 64 < max_offset; word++) {
+				std::uint64_t bits = present[word];
+				for (std::uint32_t rest = mask; rest != 0 && bits != 0;
+						rest &= rest - 1) {
+					bits &= parts[count_trailing_zeros(rest)][word];
+				}
+
+				std::size_t left_bits = max_offset - word * 64;
+				if (left_bits < 64)
+					bits &= (static_cast<std::uint64_t>(1) << left_bits) - 1;
+
+				if (bits != 0)
+					return word * 64 + count_trailing_zeros(bits) + 1;
+			}
+
+			return 0;
+		}
+	};
+
+	const Callback &callback;
+	Side sides[2]{};
+};
+
+template<typename HumanPtr, typename Callback>
 inline std::pair<std::size_t, std::size_t> search_for_parts(
 	std::size_t fuzz_range,
-	const std::vector<libaction::BodyPart::PartIndex> &parts,
-	const std::function<std::pair<bool, HumanPtr>(std::size_t relative_pos, bool left)>
-		&callback)
+	std::uint32_t parts,
+	PresenceIndex<HumanPtr, Callback> &index)
 {
 	if (fuzz_range < 2) {
 		// impossible
@@ -214,50 +207,39 @@ inline std::pair<std::size_t, std::size_t> search_for_parts(
 	}
 
 	// try to find the first pose that contains parts on the left
-	bool found = false;
-	std::size_t loff = 1;
-	for (; loff < fuzz_range; loff += 1)
-	{
-		bool valid;
-		HumanPtr human;
-		std::tie(valid, human) = callback(loff, true);
-		if (!valid) {
-			// reached the left bound
-			found = false;
-			break;
-		}
-		if (human && has_parts(*human, parts)) {
-			found = true;
-			break;
-		}
-	}
-	if (!found)
+	std::size_t loff = index.find(parts, true, fuzz_range - 1);
+	if (loff == 0)
 		return std::make_pair(0, 0);
 
 	// try to find the first pose that contains parts on the right
-	found = false;
-	std::size_t roff = 1;
-	for(; roff <= fuzz_range - loff; roff += 1)
-	{
-		bool valid;
-		HumanPtr human;
-		std::tie(valid, human) = callback(roff, false);
-		if (!valid) {
-			// reached the right bound
-			found = false;
-			break;
-		}
-		if (human && has_parts(*human, parts)) {
-			found = true;
-			break;
-		}
-	}
-	if (!found)
+	std::size_t roff = index.find(parts, false, fuzz_range - loff);
+	if (roff == 0)
 		return std::make_pair(0, 0);
 
 	return std::make_pair(loff, roff);
 }
 
+/// A rule found applicable, with its score and the frames it uses.
+struct Candidate
+{
+	float score;
+	std::size_t rule;
+	std::size_t left_offset;
+	std::size_t right_offset;
+};
+
+/// Order of candidates in a max-heap: higher scores first, then lower rule
+/// indices.
+struct CandidateLess
+{
+	inline bool operator()(const Candidate &a, const Candidate &b) const
+	{
+		if (a.score != b.score)
+			return a.score < b.score;
+		return a.rule > b.rule;
+	}
+};
+
 inline float get_relative_fuzz_score(
 	std::size_t left_offset,
 	std::size_t right_offset,
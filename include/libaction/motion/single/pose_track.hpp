@@ -0,0 +1,428 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__SINGLE__POSE_TRACK_HPP_
+#define LIBACTION__MOTION__SINGLE__POSE_TRACK_HPP_
+
+#include "../../body_part.hpp"
+#include "../../human.hpp"
+#include "../multi/deserialize/detail.hpp"
+#include "../multi/serialize/detail.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace single
+{
+
+/// Struct-of-arrays storage for the motion of a single person.
+
+/// For every body part, the coordinates and the scores across all frames are
+/// stored in contiguous arrays, so walking one part through the sequence is a
+/// linear scan. The presence of each part is recorded in a per-frame bitmap,
+/// in which bit `i` is set if the part with index `i` exists. Values of absent
+/// parts are stored as 0.
+class PoseTrack
+{
+public:
+	/// The number of body parts tracked for each frame.
+	static constexpr std::size_t parts_size =
+		static_cast<std::size_t>(libaction::BodyPart::PartIndex::end);
+
+	static_assert(parts_size < 32, "parts_size < 32");
+
+	/// Construct an empty track.
+	inline PoseTrack() {}
+
+	/// Construct from action data.
+
+	/// @param[in]  action      Action data of the format
+	///                         List<Map<Index, libaction::Human>>, where
+	///                         `List` is an iterable of `Map`, `Map` is an
+	///                         iterable of `std::pair<Index, libaction::Human>`,
+	///                         and `Index` is an unsigned integral identifying
+	///                         each person.
+	/// @param[in]  index       The index of the person to be tracked.
+	template<typename Action>
+	inline explicit PoseTrack(const Action &action, std::size_t index = 0)
+	{
+		reserve(action.size());
+
+		for (auto &human_map: action) {
+			const libaction::Human *human = nullptr;
+			for (auto &human_pair: human_map) {
+				if (static_cast<std::size_t>(human_pair.first) == index) {
+					human = &human_pair.second;
+					break;
+				}
+			}
+			push_back(human);
+		}
+	}
+
+	/// The number of frames.
+
+	/// @return                 The number of frames.
+	inline std::size_t size() const
+	{
+		return humans_.size();
+	}
+
+	/// Whether the track contains no frame.
+
+	/// @return                 Whether the track contains no frame.
+	inline bool empty() const
+	{
+		return humans_.empty();
+	}
+
+	/// Reserve storage for frames.
+
+	/// @param[in]  frames      The number of frames to reserve storage for.
+	inline void reserve(std::size_t frames)
+	{
+		humans_.reserve(frames);
+		masks_.reserve(frames);
+		for (std::size_t i = 0; i < parts_size; i++) {
+			x_[i].reserve(frames);
+			y_[i].reserve(frames);
+			score_[i].reserve(frames);
+		}
+	}
+
+	/// Remove all frames.
+	inline void clear()
+	{
+		humans_.clear();
+		masks_.clear();
+		for (std::size_t i = 0; i < parts_size; i++) {
+			x_[i].clear();
+			y_[i].clear();
+			score_[i].clear();
+		}
+	}
+
+	/// Append a frame.
+
+	/// @param[in]  human       The person in the frame, or `nullptr` if the
+	///                         person does not exist in the frame.
+	inline void push_back(const libaction::Human *human)
+	{
+		std::uint32_t mask = 0;
+
+		for (std::size_t i = 0; i < parts_size; i++) {
+			float x = 0.0f, y = 0.0f, score = 0.0f;
+
+			if (human) {
+				auto it = human->body_parts().find(
+					static_cast<libaction::BodyPart::PartIndex>(i));
+				if (it != human->body_parts().end()) {
+					mask |= (1UL << i);
+					x = it->second.x();
+					y = it->second.y();
+					score = it->second.score();
+				}
+			}
+
+			x_[i].push_back(x);
+			y_[i].push_back(y);
+			score_[i].push_back(score);
+		}
+
+		humans_.push_back(human != nullptr);
+		masks_.push_back(mask);
+	}
+
+	/// Append a frame.
+
+	/// @param[in]  human       The person in the frame.
+	inline void push_back(const libaction::Human &human)
+	{
+		push_back(&human);
+	}
+
+	/// Whether the person exists in a frame.
+
+	/// @param[in]  frame       The index of the frame.
+	/// @return                 Whether the person exists in the frame.
+	inline bool has_human(std::size_t frame) const
+	{
+		return humans_.at(frame);
+	}
+
+	/// The presence bitmap of the body parts in a frame.
+
+	/// @param[in]  frame       The index of the frame.
+	/// @return                 A bitmap in which bit `i` is set if the part
+	///                         with index `i` exists in the frame.
+	inline std::uint32_t mask(std::size_t frame) const
+	{
+		return masks_.at(frame);
+	}
+
+	/// Whether a body part exists in a frame.
+
+	/// @param[in]  frame       The index of the frame.
+	/// @param[in]  part_index  Index of the body part.
+	/// @return                 Whether the body part exists in the frame.
+	inline bool has_part(std::size_t frame,
+		libaction::BodyPart::PartIndex part_index) const
+	{
+		return (mask(frame) & (1UL << static_cast<std::size_t>(part_index)))
+			!= 0;
+	}
+
+	/// X-coordinates of a body part across all frames.
+
+	/// @param[in]  part_index  Index of the body part.
+	/// @return                 X-coordinates indexed by frame.
+	inline const std::vector<float> &x(
+		libaction::BodyPart::PartIndex part_index) const
+	{
+		return x_.at(static_cast<std::size_t>(part_index));
+	}
+
+	/// Y-coordinates of a body part across all frames.
+
+	/// @param[in]  part_index  Index of the body part.
+	/// @return                 Y-coordinates indexed by frame.
+	inline const std::vector<float> &y(
+		libaction::BodyPart::PartIndex part_index) const
+	{
+		return y_.at(static_cast<std::size_t>(part_index));
+	}
+
+	/// Scores of a body part across all frames.
+
+	/// @param[in]  part_index  Index of the body part.
+	/// @return                 Scores indexed by frame.
+	inline const std::vector<float> &score(
+		libaction::BodyPart::PartIndex part_index) const
+	{
+		return score_.at(static_cast<std::size_t>(part_index));
+	}
+
+	/// The person in a frame.
+
+	/// @param[in]  frame       The index of the frame.
+	/// @return                 The person in the frame, or `nullptr` if the
+	///                         person does not exist in the frame.
+	inline std::unique_ptr<libaction::Human> human(std::size_t frame) const
+	{
+		if (!has_human(frame))
+			return std::unique_ptr<libaction::Human>();
+
+		std::uint32_t frame_mask = mask(frame);
+
+		std::list<libaction::BodyPart> parts;
+		for (std::size_t i = 0; i < parts_size; i++) {
+			if ((frame_mask & (1UL << i)) != 0) {
+				parts.push_back(libaction::BodyPart(
+					static_cast<libaction::BodyPart::PartIndex>(i),
+					x_[i][frame], y_[i][frame], score_[i][frame]));
+			}
+		}
+
+		return std::unique_ptr<libaction::Human>(new libaction::Human(parts));
+	}
+
+	/// Convert to action data.
+
+	/// @param[in]  index       The index of the person in the result.
+	/// @return                 Action data as a frame list of indexed humans.
+	inline std::unique_ptr<std::list<std::unordered_map<
+		std::size_t, libaction::Human>>>
+	to_action(std::size_t index = 0) const
+	{
+		auto action = std::unique_ptr<std::list<std::unordered_map<
+			std::size_t, libaction::Human>>>(
+				new std::list<std::unordered_map<
+					std::size_t, libaction::Human>>());
+
+		for (std::size_t i = 0; i < size(); i++) {
+			action->emplace_back();
+
+			auto current = human(i);
+			if (current)
+				action->back().insert(std::make_pair(index, std::move(*current)));
+		}
+
+		return action;
+	}
+
+	/// Serialize the track into bytes.
+
+	/// The result is identical to serializing to_action() with
+	/// motion::multi::serialize::serialize(), without materializing the
+	/// intermediate humans.
+
+	/// @param[in]  index       The index of the person in the result.
+	/// @param[in]  magic       Whether the magic number should be included.
+	/// @return                 Serialized bytes.
+	/// @exception              std::runtime_error
+	/// @sa                     motion::multi::serialize::serialize
+	inline std::unique_ptr<std::vector<std::uint8_t>>
+	serialize(std::size_t index = 0, bool magic = true) const
+	{
+		namespace serialize_detail = libaction::motion::multi::serialize::detail;
+
+		auto data = std::unique_ptr<std::vector<std::uint8_t>>(
+			new std::vector<std::uint8_t>());
+
+		if (magic) {
+			data->push_back(static_cast<std::uint8_t>('A'));
+			data->push_back(static_cast<std::uint8_t>('C'));
+			data->push_back(static_cast<std::uint8_t>('T'));
+			data->push_back(0);
+		}
+
+		if (size() >= serialize_detail::max)
+			throw std::runtime_error("too many items");
+
+		std::uint32_t person = index;
+		if (index > serialize_detail::max)
+			person = serialize_detail::max;
+
+		serialize_detail::write_int(static_cast<std::uint32_t>(size()), *data);
+
+		for (std::size_t i = 0; i < size(); i++) {
+			if (!has_human(i)) {
+				serialize_detail::write_int(static_cast<std::uint32_t>(0),
+					*data);
+				continue;
+			}
+
+			serialize_detail::write_int(static_cast<std::uint32_t>(1), *data);
+			serialize_detail::write_int(person, *data);
+
+			std::uint32_t frame_mask = mask(i);
+			std::uint32_t bitmap = 0;
+			for (std::size_t j = 0; j < parts_size; j++) {
+				if ((frame_mask & (1UL << j)) != 0)
+					bitmap |= (1UL << (31 - j));
+			}
+			serialize_detail::write_int(bitmap, *data);
+
+			for (std::size_t j = 0; j < parts_size; j++) {
+				if ((frame_mask & (1UL << j)) != 0) {
+					serialize_detail::write_float(x_[j][i], *data);
+					serialize_detail::write_float(y_[j][i], *data);
+					serialize_detail::write_float(score_[j][i], *data);
+				}
+			}
+		}
+
+		return data;
+	}
+
+	/// Deserialize a track from bytes.
+
+	/// @param[in]  data        Action data in bytes in a standard container.
+	/// @param[in]  index       The index of the person to be tracked.
+	/// @param[in]  magic       Whether the magic number is included in `data`.
+	/// @return                 The track of the person.
+	/// @exception              std::runtime_error
+	/// @sa                     motion::multi::deserialize::deserialize
+	template<typename Data>
+	static inline std::unique_ptr<PoseTrack>
+	deserialize(const Data &data, std::size_t index = 0, bool magic = true)
+	{
+		namespace deserialize_detail =
+			libaction::motion::multi::deserialize::detail;
+
+		typename Data::const_iterator it = data.begin();
+
+		if (magic)
+			deserialize_detail::read_int<std::uint32_t>(it, data.end());	// ignore 4 bytes
+
+		auto action_size = deserialize_detail::read_int<std::uint32_t>(
+			it, data.end());
+		if (action_size >= deserialize_detail::max)
+			throw std::runtime_error("too many items");
+
+		if (index > deserialize_detail::max)
+			index = deserialize_detail::max;
+
+		auto track = std::unique_ptr<PoseTrack>(new PoseTrack());
+		track->reserve(action_size);
+
+		for (std::uint32_t i = 0; i < action_size; i++) {
+			auto human_map_size = deserialize_detail::read_int<std::uint32_t>(
+				it, data.end());
+			if (human_map_size >= deserialize_detail::max)
+				throw std::runtime_error("too many items");
+
+			bool found = false;
+			std::uint32_t frame_mask = 0;
+			std::array<float, parts_size> x{}, y{}, score{};
+
+			for (std::uint32_t j = 0; j < human_map_size; j++) {
+				std::size_t person = deserialize_detail::read_int<std::uint32_t>(
+					it, data.end());
+				if (person > deserialize_detail::max)
+					person = deserialize_detail::max;
+
+				auto ind = deserialize_detail::read_body_parts_bitmap(
+					it, data.end());
+
+				bool current = (!found && person == index);
+				for (auto part_index: ind) {
+					float part_x = deserialize_detail::read_float(it, data.end());
+					float part_y = deserialize_detail::read_float(it, data.end());
+					float part_score = deserialize_detail::read_float(
+						it, data.end());
+
+					if (!current || std::isnan(part_x) || std::isnan(part_y) ||
+							std::isnan(part_score))
+						continue;
+
+					auto k = static_cast<std::size_t>(part_index);
+					frame_mask |= (1UL << k);
+					x[k] = part_x;
+					y[k] = part_y;
+					score[k] = part_score;
+				}
+
+				if (current)
+					found = true;
+			}
+
+			for (std::size_t k = 0; k < parts_size; k++) {
+				track->x_[k].push_back(x[k]);
+				track->y_[k].push_back(y[k]);
+				track->score_[k].push_back(score[k]);
+			}
+			track->humans_.push_back(found);
+			track->masks_.push_back(frame_mask);
+		}
+
+		return track;
+	}
+
+private:
+	std::vector<bool> humans_{};
+	std::vector<std::uint32_t> masks_{};
+	std::array<std::vector<float>, parts_size> x_{}, y_{}, score_{};
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,241 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__MOTION__SINGLE__STREAM_HPP_
+#define LIBACTION__MOTION__SINGLE__STREAM_HPP_
+
+#include "../../body_part.hpp"
+#include "../../human.hpp"
+#include "estimator.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libaction
+{
+namespace motion
+{
+namespace single
+{
+
+/// Single-person motion estimation on a stream of frames.
+
+/// Frames are pushed one by one, without knowing the total number of frames
+/// in advance. The estimation of a frame is finished as soon as the frames
+/// within its context (fuzz, anti crossing and zoom ranges) have arrived, so
+/// results lag behind by lag() frames. Only the frames within the context
+/// are kept.
+///
+/// @tparam     StillEstimator      See Estimator::estimate().
+/// @tparam     ZoomStillEstimator  See Estimator::estimate().
+/// @tparam     Image       The image type, which must conform to the
+///                         Boost.MultiArray concept.
+/// @tparam     PackedPoses See BasicEstimator.
+/// @warning This class is not thread safe, although it contains multithread
+///          features.
+template<typename StillEstimator, typename ZoomStillEstimator, typename Image,
+	bool PackedPoses = detail::packed_pose_cache>
+class Stream
+{
+public:
+	/// A pointer to a frame.
+	using ImagePtr = std::shared_ptr<const Image>;
+
+	/// Action data of estimated frames.
+	using Action = std::list<std::unordered_map<std::size_t, libaction::Human>>;
+
+	/// Constructor.
+
+	/// See Estimator::estimate() for the parameters.
+	inline Stream(
+		std::size_t fuzz_range,
+		const std::vector<std::tuple<
+			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+			float>> &max_lengths,
+		bool anti_crossing,
+		bool zoom, std::size_t zoom_range, std::size_t zoom_rate,
+		const std::vector<StillEstimator*> &still_estimators,
+		const std::vector<ZoomStillEstimator*> &zoom_still_estimators
+	)
+	:
+	fuzz_range(fuzz_range), max_lengths(max_lengths),
+	anti_crossing(anti_crossing),
+	zoom(zoom), zoom_range(zoom_range), zoom_rate(zoom_rate),
+	still_estimators(still_estimators),
+	zoom_still_estimators(zoom_still_estimators)
+	{
+		if (zoom_rate == 0)
+			throw std::runtime_error("zoom_rate == 0");
+		if (still_estimators.empty())
+			throw std::runtime_error("still_estimators is empty");
+		if (still_estimators.size() != zoom_still_estimators.size())
+			throw std::runtime_error("still_estimators and "
+				"zoom_still_estimators have different sizes");
+	}
+
+	/// The number of frames a result lags behind the last frame pushed.
+
+	/// @return                 The number of frames after a frame required
+	///                         for finishing its estimation.
+	inline std::size_t lag() const
+	{
+		return (fuzz_range != 0 ? fuzz_range - 1 : 0) +
+			(anti_crossing ? 1 : 0) + (zoom ? zoom_range : 0);
+	}
+
+	/// The number of frames pushed since the stream started.
+	inline std::size_t pushed() const
+	{
+		return frames_first + frames.size();
+	}
+
+	/// The number of frames estimated since the stream started.
+	inline std::size_t finished() const
+	{
+		return next;
+	}
+
+	/// The underlying estimator, which may be used for setting up prefetching
+	/// or the image cache.
+	inline BasicEstimator<PackedPoses> &estimator()
+	{
+		return motion_estimator;
+	}
+
+	/// Push a frame.
+
+	/// @param[in]  image       The next frame.
+	/// @return                 Action data of the frames finished by this
+	///                         frame, starting from frame finished() before
+	///                         the call. May be empty.
+	/// @exception              std::runtime_error
+	inline std::unique_ptr<Action> push(ImagePtr image)
+	{
+		if (!image)
+			throw std::runtime_error("image is null");
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			frames.push_back(std::move(image));
+		}
+
+		auto action = std::unique_ptr<Action>(new Action());
+		while (next + lag() < pushed())
+			action->push_back(std::move(*estimate_next()));
+
+		return action;
+	}
+
+	/// Finish the stream.
+
+	/// The remaining frames are estimated, and the stream is restarted
+	/// afterwards.
+	///
+	/// @return                 Action data of the remaining frames, starting
+	///                         from frame finished() before the call.
+	/// @exception              std::runtime_error
+	inline std::unique_ptr<Action> flush()
+	{
+		auto action = std::unique_ptr<Action>(new Action());
+		while (next < pushed())
+			action->push_back(std::move(*estimate_next()));
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			frames.clear();
+			frames_first = 0;
+		}
+		next = 0;
+		motion_estimator.reset();
+
+		return action;
+	}
+
+private:
+	std::size_t fuzz_range;
+	std::vector<std::tuple<
+		libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex,
+		float>> max_lengths;
+	bool anti_crossing;
+	bool zoom;
+	std::size_t zoom_range;
+	std::size_t zoom_rate;
+	std::vector<StillEstimator*> still_estimators;
+	std::vector<ZoomStillEstimator*> zoom_still_estimators;
+
+	BasicEstimator<PackedPoses> motion_estimator{};
+
+	// guards frames and frames_first, which may be accessed from the
+	// estimator threads
+	std::mutex mutex{};
+	// frames from frames_first, or nullptr if no longer needed
+	std::deque<ImagePtr> frames{};
+	std::size_t frames_first = 0;
+
+	// the next frame to estimate
+	std::size_t next = 0;
+
+	inline ImagePtr get_frame(std::size_t pos, bool last_image_access)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (pos < frames_first || pos - frames_first >= frames.size() ||
+				!frames[pos - frames_first])
+			throw std::runtime_error("frame is no longer available");
+
+		auto image = frames[pos - frames_first];
+		// frames which may be zoomed can be retrieved again for zoom
+		// reestimation, so they are kept until out of the context
+		if (last_image_access && !(zoom && pos % zoom_rate == 0))
+			frames[pos - frames_first].reset();
+
+		return image;
+	}
+
+	// Estimate the next frame. All frames within its context must have been
+	// pushed, unless the stream is being flushed.
+	inline std::unique_ptr<std::unordered_map<std::size_t, libaction::Human>>
+	estimate_next()
+	{
+		// Frames within the context are not affected by the length, so the
+		// number of frames pushed so far can be used as the length.
+		std::function<ImagePtr(std::size_t pos, bool last_image_access)>
+		callback = [this] (std::size_t pos, bool last_image_access) {
+			return get_frame(pos, last_image_access);
+		};
+
+		auto humans = motion_estimator.estimate(next, pushed(),
+			fuzz_range, max_lengths, anti_crossing,
+			zoom, zoom_range, zoom_rate,
+			still_estimators, zoom_still_estimators, callback);
+		next++;
+
+		// drop frames out of the context of the remaining frames
+		std::unique_lock<std::mutex> lock(mutex);
+		while (frames_first + lag() < next && !frames.empty()) {
+			frames.pop_front();
+			frames_first++;
+		}
+
+		return humans;
+	}
+};
+
+}
+}
+}
+
+#endif
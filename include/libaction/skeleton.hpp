@@ -0,0 +1,232 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This Source Code Form is "Incompatible With Secondary Licenses", as
+ * defined by the Mozilla Public License, v. 2.0. */
+
+#ifndef LIBACTION__SKELETON_HPP_
+#define LIBACTION__SKELETON_HPP_
+
+#include "body_part.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libaction
+{
+/// Compile-time descriptions of the human body graph.
+
+/// A skeleton is a type with the following static members, which algorithms
+/// accept as a template parameter:
+///
+/// - `parts_size`: the number of body parts (at most 32);
+/// - `connections`: an array of PartPair, the connections of the body used for
+///   scoring;
+/// - `mirrors`: an array of PartPair, the pairs of (left, right) body parts;
+/// - `relative_rules`: an array of PartPair, the (source, target) rules used
+///   for relative fuzz estimation, in order of preference;
+/// - `absolute_rules`: an array of BodyPart::PartIndex, the parts used for
+///   absolute fuzz estimation, in order of preference;
+/// - `limbs`: a bitmap (see mask()) of the parts excluded from the
+///   significant vertical (y) range of a pose.
+namespace skeleton
+{
+
+/// A pair of body parts.
+struct PartPair
+{
+	/// The first body part.
+	libaction::BodyPart::PartIndex first;
+	/// The second body part.
+	libaction::BodyPart::PartIndex second;
+};
+
+/// The bit representing a body part in a bitmap of body parts.
+
+/// @param[in]  part_index  Index of the body part.
+/// @return                 The bitmap with only the bit of `part_index` set.
+constexpr std::uint32_t mask(libaction::BodyPart::PartIndex part_index)
+{
+	return static_cast<std::uint32_t>(1) << static_cast<int>(part_index);
+}
+
+/// The skeleton of BodyPart::PartIndex with 18 body parts.
+
+/// Use Coco18 instead of this template, whose parameter only allows the
+/// tables to be defined in a header.
+template<typename = void>
+struct BasicCoco18
+{
+	/// The number of body parts.
+	static constexpr std::size_t parts_size =
+		static_cast<std::size_t>(libaction::BodyPart::PartIndex::end);
+
+	/// Connections of the body used for scoring.
+	static constexpr PartPair connections[] = {
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::elbow_r },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::elbow_l },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::shoulder_l },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::hip_r },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::hip_l },
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::elbow_r, libaction::BodyPart::PartIndex::wrist_r },
+		{ libaction::BodyPart::PartIndex::elbow_l, libaction::BodyPart::PartIndex::wrist_l },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::eye_r },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::eye_l },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::ear_r },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::ear_l },
+		{ libaction::BodyPart::PartIndex::eye_r, libaction::BodyPart::PartIndex::eye_l },
+		{ libaction::BodyPart::PartIndex::ear_r, libaction::BodyPart::PartIndex::ear_l },
+		{ libaction::BodyPart::PartIndex::hip_r, libaction::BodyPart::PartIndex::hip_l },
+		{ libaction::BodyPart::PartIndex::hip_r, libaction::BodyPart::PartIndex::knee_r },
+		{ libaction::BodyPart::PartIndex::hip_l, libaction::BodyPart::PartIndex::knee_l },
+		{ libaction::BodyPart::PartIndex::knee_r, libaction::BodyPart::PartIndex::ankle_r },
+		{ libaction::BodyPart::PartIndex::knee_l, libaction::BodyPart::PartIndex::ankle_l }
+	};
+
+	/// Pairs of (left, right) body parts.
+	static constexpr PartPair mirrors[] = {
+		{ libaction::BodyPart::PartIndex::eye_l, libaction::BodyPart::PartIndex::eye_r },
+		{ libaction::BodyPart::PartIndex::ear_l, libaction::BodyPart::PartIndex::ear_r },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::shoulder_r },
+		{ libaction::BodyPart::PartIndex::elbow_l, libaction::BodyPart::PartIndex::elbow_r },
+		{ libaction::BodyPart::PartIndex::wrist_l, libaction::BodyPart::PartIndex::wrist_r },
+		{ libaction::BodyPart::PartIndex::hip_l, libaction::BodyPart::PartIndex::hip_r },
+		{ libaction::BodyPart::PartIndex::knee_l, libaction::BodyPart::PartIndex::knee_r },
+		{ libaction::BodyPart::PartIndex::ankle_l, libaction::BodyPart::PartIndex::ankle_r }
+	};
+
+	/// Rules of (source, target) for relative fuzz estimation.
+	static constexpr PartPair relative_rules[] = {
+		// same name
+		{ libaction::BodyPart::PartIndex::eye_r, libaction::BodyPart::PartIndex::eye_l },
+		{ libaction::BodyPart::PartIndex::eye_l, libaction::BodyPart::PartIndex::eye_r },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::shoulder_l },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::shoulder_r },
+		{ libaction::BodyPart::PartIndex::ear_r, libaction::BodyPart::PartIndex::ear_l },
+		{ libaction::BodyPart::PartIndex::ear_l, libaction::BodyPart::PartIndex::ear_r },
+		{ libaction::BodyPart::PartIndex::hip_r, libaction::BodyPart::PartIndex::hip_l },
+		{ libaction::BodyPart::PartIndex::hip_l, libaction::BodyPart::PartIndex::hip_r },
+		// same side / both no side
+		{ libaction::BodyPart::PartIndex::eye_r, libaction::BodyPart::PartIndex::ear_r },
+		{ libaction::BodyPart::PartIndex::eye_l, libaction::BodyPart::PartIndex::ear_l },
+		{ libaction::BodyPart::PartIndex::knee_r, libaction::BodyPart::PartIndex::ankle_r },
+		{ libaction::BodyPart::PartIndex::knee_l, libaction::BodyPart::PartIndex::ankle_l },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::hip_r },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::hip_l },
+		{ libaction::BodyPart::PartIndex::hip_r, libaction::BodyPart::PartIndex::knee_r },
+		{ libaction::BodyPart::PartIndex::hip_l, libaction::BodyPart::PartIndex::knee_l },
+		{ libaction::BodyPart::PartIndex::knee_r, libaction::BodyPart::PartIndex::hip_r },
+		{ libaction::BodyPart::PartIndex::knee_l, libaction::BodyPart::PartIndex::hip_l },
+		{ libaction::BodyPart::PartIndex::hip_r, libaction::BodyPart::PartIndex::shoulder_r },
+		{ libaction::BodyPart::PartIndex::hip_l, libaction::BodyPart::PartIndex::shoulder_l },
+		{ libaction::BodyPart::PartIndex::ankle_r, libaction::BodyPart::PartIndex::knee_r },
+		{ libaction::BodyPart::PartIndex::ankle_l, libaction::BodyPart::PartIndex::knee_l },
+		{ libaction::BodyPart::PartIndex::ear_r, libaction::BodyPart::PartIndex::eye_r },
+		{ libaction::BodyPart::PartIndex::ear_l, libaction::BodyPart::PartIndex::eye_l },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::elbow_r },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::elbow_l },
+		{ libaction::BodyPart::PartIndex::elbow_r, libaction::BodyPart::PartIndex::shoulder_r },
+		{ libaction::BodyPart::PartIndex::elbow_l, libaction::BodyPart::PartIndex::shoulder_l },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::elbow_r, libaction::BodyPart::PartIndex::wrist_r },
+		{ libaction::BodyPart::PartIndex::elbow_l, libaction::BodyPart::PartIndex::wrist_l },
+		{ libaction::BodyPart::PartIndex::wrist_r, libaction::BodyPart::PartIndex::elbow_r },
+		{ libaction::BodyPart::PartIndex::wrist_l, libaction::BodyPart::PartIndex::elbow_l },
+		// side -> no side
+		{ libaction::BodyPart::PartIndex::eye_r, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::eye_l, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::ear_r, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::ear_l, libaction::BodyPart::PartIndex::nose },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::eye_r, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::eye_l, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::ear_r, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::ear_l, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::hip_r, libaction::BodyPart::PartIndex::neck },
+		{ libaction::BodyPart::PartIndex::hip_l, libaction::BodyPart::PartIndex::neck },
+		// no side -> side
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::shoulder_r },
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::shoulder_l },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::ear_r },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::ear_l },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::eye_r },
+		{ libaction::BodyPart::PartIndex::nose, libaction::BodyPart::PartIndex::eye_l },
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::ear_r },
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::ear_l },
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::eye_r },
+		{ libaction::BodyPart::PartIndex::neck, libaction::BodyPart::PartIndex::eye_l },
+		// different sides
+		{ libaction::BodyPart::PartIndex::eye_r, libaction::BodyPart::PartIndex::ear_l },
+		{ libaction::BodyPart::PartIndex::eye_l, libaction::BodyPart::PartIndex::ear_r },
+		{ libaction::BodyPart::PartIndex::shoulder_r, libaction::BodyPart::PartIndex::hip_l },
+		{ libaction::BodyPart::PartIndex::shoulder_l, libaction::BodyPart::PartIndex::hip_r },
+		{ libaction::BodyPart::PartIndex::hip_r, libaction::BodyPart::PartIndex::shoulder_l },
+		{ libaction::BodyPart::PartIndex::hip_l, libaction::BodyPart::PartIndex::shoulder_r },
+		{ libaction::BodyPart::PartIndex::ear_r, libaction::BodyPart::PartIndex::eye_l },
+		{ libaction::BodyPart::PartIndex::ear_l, libaction::BodyPart::PartIndex::eye_r }
+	};
+
+	/// Parts for absolute fuzz estimation.
+	static constexpr libaction::BodyPart::PartIndex absolute_rules[] = {
+		libaction::BodyPart::PartIndex::ankle_r,
+		libaction::BodyPart::PartIndex::ankle_l,
+		libaction::BodyPart::PartIndex::neck,
+		libaction::BodyPart::PartIndex::shoulder_r,
+		libaction::BodyPart::PartIndex::shoulder_l,
+		libaction::BodyPart::PartIndex::hip_r,
+		libaction::BodyPart::PartIndex::hip_l,
+		libaction::BodyPart::PartIndex::knee_r,
+		libaction::BodyPart::PartIndex::knee_l,
+		libaction::BodyPart::PartIndex::nose,
+		libaction::BodyPart::PartIndex::eye_r,
+		libaction::BodyPart::PartIndex::eye_l,
+		libaction::BodyPart::PartIndex::ear_r,
+		libaction::BodyPart::PartIndex::ear_l,
+		libaction::BodyPart::PartIndex::elbow_r,
+		libaction::BodyPart::PartIndex::elbow_l,
+		libaction::BodyPart::PartIndex::wrist_r,
+		libaction::BodyPart::PartIndex::wrist_l
+	};
+
+	/// Parts excluded from the significant vertical (y) range.
+	static constexpr std::uint32_t limbs =
+		mask(libaction::BodyPart::PartIndex::wrist_r) |
+		mask(libaction::BodyPart::PartIndex::wrist_l) |
+		mask(libaction::BodyPart::PartIndex::elbow_r) |
+		mask(libaction::BodyPart::PartIndex::elbow_l) |
+		mask(libaction::BodyPart::PartIndex::ankle_r) |
+		mask(libaction::BodyPart::PartIndex::ankle_l) |
+		mask(libaction::BodyPart::PartIndex::knee_r) |
+		mask(libaction::BodyPart::PartIndex::knee_l);
+
+	static_assert(parts_size <= 32, "parts_size <= 32");
+};
+
+template<typename T>
+constexpr std::size_t BasicCoco18<T>::parts_size;
+template<typename T>
+constexpr PartPair BasicCoco18<T>::connections[];
+template<typename T>
+constexpr PartPair BasicCoco18<T>::mirrors[];
+template<typename T>
+constexpr PartPair BasicCoco18<T>::relative_rules[];
+template<typename T>
+constexpr libaction::BodyPart::PartIndex BasicCoco18<T>::absolute_rules[];
+template<typename T>
+constexpr std::uint32_t BasicCoco18<T>::limbs;
+
+/// The skeleton of BodyPart::PartIndex with 18 body parts.
+using Coco18 = BasicCoco18<>;
+
+}
+}
+
+#endif
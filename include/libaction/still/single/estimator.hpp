@@ -10,6 +10,7 @@
 
 #include "../../body_part.hpp"
 #include "../../human.hpp"
+#include "../../skeleton.hpp"
 #include "../../detail/image.hpp"
 #include "../detail/array.hpp"
 #include "detail/error_reporter.hpp"
@@ -22,6 +23,7 @@
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <set>
@@ -69,6 +71,13 @@ private:
 	}
 
 public:
+	/// The body parts the estimator can produce, as a bitmap (see
+	/// skeleton::mask()). The neck is never produced.
+	static constexpr std::uint32_t parts =
+		((static_cast<std::uint32_t>(1) <<
+			static_cast<int>(libaction::BodyPart::PartIndex::end)) - 1) &
+		~libaction::skeleton::mask(libaction::BodyPart::PartIndex::neck);
+
 	/// Construct from a file.
 
 	/// @param[in]  graph_path  The path to the graph file.
@@ -265,6 +274,9 @@ private:
 	}
 };
 
+template<typename Value>
+constexpr std::uint32_t Estimator<Value>::parts;
+
 }
 }
 }
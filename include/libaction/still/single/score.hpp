@@ -10,6 +10,7 @@
 
 #include "../../body_part.hpp"
 #include "../../human.hpp"
+#include "../../skeleton.hpp"
 #include "score/detail.hpp"
 
 #include <algorithm>
@@ -31,19 +32,21 @@ namespace score
 
 /// Score a human pose against another one.
 
+/// @tparam     Skeleton    The skeleton whose connections are scored.
 /// @param[in]  human1      The human pose to be scored.
 /// @param[in]  human2      The baseline human pose.
 /// @return                 A map mapping body connections to their scores. The
 ///                         score is within the range [0, 128]. Higher is
 ///                         better.
+template<typename Skeleton = libaction::skeleton::Coco18>
 inline std::unique_ptr<std::map<std::pair<
 		libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex>,
 	std::uint8_t>>
 score(const libaction::Human &human1, const libaction::Human &human2)
 {
 	float x_range1, y_range1, x_range2, y_range2;
-	std::tie(x_range1, y_range1) = detail::sig_range(human1);
-	std::tie(x_range2, y_range2) = detail::sig_range(human2);
+	std::tie(x_range1, y_range1) = detail::sig_range<Skeleton>(human1);
+	std::tie(x_range2, y_range2) = detail::sig_range<Skeleton>(human2);
 
 	auto scores = std::unique_ptr<std::map<std::pair<
 		libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex>,
@@ -52,7 +55,7 @@ score(const libaction::Human &human1, const libaction::Human &human2)
 			libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex>,
 		std::uint8_t>());
 
-	for (auto &connection: detail::score_connections()) {
+	for (auto &connection: Skeleton::connections) {
 		auto human1_from_it = human1.body_parts().find(connection.first);
 		if (human1_from_it == human1.body_parts().end())
 			continue;
@@ -10,6 +10,7 @@
 
 #include "../../../body_part.hpp"
 #include "../../../human.hpp"
+#include "../../../skeleton.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -30,39 +31,6 @@ namespace score
 namespace detail
 {
 
-inline std::vector<std::pair<
-	libaction::BodyPart::PartIndex, libaction::BodyPart::PartIndex>>
-score_connections()
-{
-	using id = libaction::BodyPart::PartIndex;
-
-	return {
-		{ id::shoulder_r, id::elbow_r },
-		{ id::shoulder_l, id::elbow_l },
-		{ id::shoulder_r, id::shoulder_l },
-		{ id::shoulder_r, id::neck },
-		{ id::shoulder_l, id::neck },
-		{ id::shoulder_r, id::nose },
-		{ id::shoulder_l, id::nose },
-		{ id::shoulder_r, id::hip_r },
-		{ id::shoulder_l, id::hip_l },
-		{ id::neck, id::nose },
-		{ id::elbow_r, id::wrist_r },
-		{ id::elbow_l, id::wrist_l },
-		{ id::nose, id::eye_r },
-		{ id::nose, id::eye_l },
-		{ id::nose, id::ear_r },
-		{ id::nose, id::ear_l },
-		{ id::eye_r, id::eye_l },
-		{ id::ear_r, id::ear_l },
-		{ id::hip_r, id::hip_l },
-		{ id::hip_r, id::knee_r },
-		{ id::hip_l, id::knee_l },
-		{ id::knee_r, id::ankle_r },
-		{ id::knee_l, id::ankle_l }
-	};
-}
-
 inline float angle(float x, float y)
 {
 	return std::atan2(y, x);
@@ -168,21 +136,20 @@ inline float range(std::vector<float> &data)
 	return max - min;
 }
 
+template<typename Skeleton>
 inline std::pair<float, float> sig_range(const libaction::Human &human)
 {
+	if (Skeleton::limbs == libaction::skeleton::Coco18::limbs) {
+		// cached by the human
+		auto &geometry = human.geometry();
+		return std::make_pair(geometry.sig_x_range, geometry.sig_y_range);
+	}
+
 	std::vector<float> x, y;
 	for (auto &part: human.body_parts()) {
 		x.push_back(part.second.x());
-		if (part.first != libaction::BodyPart::PartIndex::wrist_r &&
-				part.first != libaction::BodyPart::PartIndex::wrist_l &&
-				part.first != libaction::BodyPart::PartIndex::elbow_r &&
-				part.first != libaction::BodyPart::PartIndex::elbow_l &&
-				part.first != libaction::BodyPart::PartIndex::ankle_r &&
-				part.first != libaction::BodyPart::PartIndex::ankle_l &&
-				part.first != libaction::BodyPart::PartIndex::knee_r &&
-				part.first != libaction::BodyPart::PartIndex::knee_l) {
+		if ((libaction::skeleton::mask(part.first) & Skeleton::limbs) == 0)
 			y.push_back(part.second.y());
-		}
 	}
 
 	float x_range = range(x);
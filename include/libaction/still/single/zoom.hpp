@@ -10,14 +10,21 @@
 
 #include "../../body_part.hpp"
 #include "../../human.hpp"
+#include "../../skeleton.hpp"
 #include "../../detail/image.hpp"
 #include "zoom/detail.hpp"
 
 #include <boost/multi_array.hpp>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace libaction
 {
@@ -53,6 +60,125 @@ get_zoom_lr(std::size_t pos, std::size_t length, std::size_t zoom_range)
 	return std::make_pair(l, r);
 }
 
+/// Policy deciding whether zoom reestimation may help a human.
+
+/// Zoom reestimation is skipped if the human already fills most of the image,
+/// or if the human is already complete and confident enough. The default
+/// policy never skips.
+struct Policy
+{
+	/// Skip if the bounding box of the human covers at least this fraction of
+	/// the image area.
+	float skip_area = std::numeric_limits<float>::infinity();
+
+	/// Skip if at most this number of body parts are missing, and the mean
+	/// score of the body parts is at least `skip_mean_score`. Only the parts
+	/// in `parts` are counted as missing.
+	std::size_t skip_missing_parts = 0;
+
+	/// The body parts the still estimator can produce, as a bitmap (see
+	/// skeleton::mask()). All parts by default. still::single::Estimator never
+	/// produces the neck, so use still::single::Estimator::parts with it.
+	std::uint32_t parts = std::numeric_limits<std::uint32_t>::max();
+
+	/// See `skip_missing_parts`.
+	float skip_mean_score = std::numeric_limits<float>::infinity();
+
+	/// Whether zoom reestimation should be done.
+
+	/// @tparam     Skeleton    The skeleton of `human`.
+	/// @param[in]  human       The result from a previous estimation.
+	/// @return                 Whether zoom reestimation should be done.
+	template<typename Skeleton = libaction::skeleton::Coco18>
+	inline bool should_zoom(const libaction::Human &human) const
+	{
+		if (human.body_parts().empty())
+			return true;
+
+		auto &geometry = human.geometry();
+		float area = (geometry.x2 - geometry.x1) * (geometry.y2 - geometry.y1);
+		if (area >= skip_area)
+			return false;
+
+		std::uint32_t found_parts = 0;
+		for (auto &part: human.body_parts())
+			found_parts |= libaction::skeleton::mask(part.first);
+
+		std::size_t missing = 0;
+		for (std::size_t i = 0; i < Skeleton::parts_size; i++) {
+			auto bit = static_cast<std::uint32_t>(1) << i;
+			if ((parts & bit) != 0 && (found_parts & bit) == 0)
+				missing++;
+		}
+		if (missing > skip_missing_parts)
+			return true;
+
+		std::size_t found = human.body_parts().size();
+
+		float score = 0.0f;
+		for (auto &part: human.body_parts())
+			score += part.second.score();
+		score /= static_cast<float>(found);
+
+		return !(score >= skip_mean_score);
+	}
+};
+
+/// Estimate on a region of an image only.
+
+/// @param[in]  image       The full image, which should conform to the
+///                         Boost.MultiArray concept.
+/// @param[in]  x1          The top bound of the region, in the coordinates of
+///                         body parts.
+/// @param[in]  x2          The bottom bound of the region.
+/// @param[in]  y1          The left bound of the region.
+/// @param[in]  y2          The right bound of the region.
+/// @param[in]  estimator_callback  Callback which returns the human found in
+///                         the given image, or `nullptr` if none is found.
+/// @return                 The human found, in the coordinates of `image`, or
+///                         `nullptr` if the region is empty or no human is
+///                         found.
+/// @exception              std::runtime_error
+template<typename Image, typename HumanPtr>
+inline std::unique_ptr<libaction::Human> region_estimate(
+	const Image &image,
+	float x1, float x2, float y1, float y2,
+	const std::function<HumanPtr(
+		const boost::multi_array<typename Image::element, 3> &image
+	)> &estimator_callback
+) {
+	if (image.num_dimensions() != 3)
+		throw std::runtime_error("image must have 3 dimensions");
+
+	std::size_t crop_x = 0, crop_y = 0;
+	auto cropped = detail::crop_region(image, x1, x2, y1, y2, crop_x, crop_y);
+	if (!cropped)
+		return nullptr;
+
+	auto cropped_human = estimator_callback(*cropped);
+	if (!cropped_human)
+		return nullptr;
+
+	std::vector<libaction::BodyPart> parts;
+	for (auto &part_pair: cropped_human->body_parts()) {
+		auto &part = part_pair.second;
+
+		auto coord = detail::coord_translate(
+			part.x(), part.y(),
+			image.shape()[0], image.shape()[1],
+			crop_x, crop_y,
+			cropped->shape()[0], cropped->shape()[1]);
+
+		parts.push_back(libaction::BodyPart(
+			part.part_index(),
+			coord.first, coord.second,
+			part.score()
+		));
+	}
+
+	return std::unique_ptr<libaction::Human>(new libaction::Human(parts));
+}
+
 /// Estimate from a known estimation with zoom-in reestimation.
 
 /// @param[in]  image       The full image for estimation, which should conform
@@ -84,22 +210,14 @@ inline std::unique_ptr<libaction::Human> zoom_estimate(
 	if (human.body_parts().empty())
 		return std::unique_ptr<libaction::Human>(new libaction::Human(human));
 
-	float x1 = human.body_parts().begin()->second.x();
-	float x2 = x1;
-	float y1 = human.body_parts().begin()->second.y();
-	float y2 = y1;
+	auto &geometry = human.geometry();
 
-	float mid_x = 0.0f, mid_y = 0.0f;
+	float x1 = geometry.x1;
+	float x2 = geometry.x2;
+	float y1 = geometry.y1;
+	float y2 = geometry.y2;
 
-	for (auto &part: human.body_parts()) {
-		x1 = std::min(x1, part.second.x());
-		x2 = std::max(x2, part.second.x());
-		y1 = std::min(y1, part.second.y());
-		y2 = std::max(y2, part.second.y());
-
-		mid_x += part.second.x() / static_cast<float>(human.body_parts().size());
-		mid_y += part.second.y() / static_cast<float>(human.body_parts().size());
-	}
+	float mid_x = geometry.mid_x, mid_y = geometry.mid_y;
 
 	float height = 0.0f, width = 0.0f;
 
@@ -109,20 +227,10 @@ inline std::unique_ptr<libaction::Human> zoom_estimate(
 		if (hint->body_parts().empty())
 			continue;
 
-		float x1 = hint->body_parts().begin()->second.x();
-		float x2 = x1;
-		float y1 = hint->body_parts().begin()->second.y();
-		float y2 = y1;
+		auto &hint_geometry = hint->geometry();
 
-		for (auto &part: hint->body_parts()) {
-			x1 = std::min(x1, part.second.x());
-			x2 = std::max(x2, part.second.x());
-			y1 = std::min(y1, part.second.y());
-			y2 = std::max(y2, part.second.y());
-		}
-
-		height = std::max(height, x2 - x1);
-		width = std::max(width, y2 - y1);
+		height = std::max(height, hint_geometry.x2 - hint_geometry.x1);
+		width = std::max(width, hint_geometry.y2 - hint_geometry.y1);
 	}
 
 	float size = std::max(height, width);
@@ -139,54 +247,10 @@ inline std::unique_ptr<libaction::Human> zoom_estimate(
 	y1 -= (y2 - y1) / 5.0f;
 	y2 += (y2 - y1) / 5.0f;
 
-	x1 = std::max(x1, +0.0f);
-	x2 = std::min(x2, 1.0f);
-	y1 = std::max(y1, +0.0f);
-	y2 = std::min(y2, 1.0f);
-
-	std::size_t x1_i = static_cast<std::size_t>(x1 * static_cast<float>(image.shape()[0]));
-	std::size_t x2_i = static_cast<std::size_t>(x2 * static_cast<float>(image.shape()[0]));
-	std::size_t y1_i = static_cast<std::size_t>(y1 * static_cast<float>(image.shape()[1]));
-	std::size_t y2_i = static_cast<std::size_t>(y2 * static_cast<float>(image.shape()[1]));
-
-	x1_i = std::min(x1_i, image.shape()[0] - 1);
-	x2_i = std::max(std::min(x2_i, image.shape()[0] - 1), x1_i);
-	y1_i = std::min(y1_i, image.shape()[1] - 1);
-	y2_i = std::max(std::min(y2_i, image.shape()[1] - 1), y1_i);
-
-	if (x1_i == x2_i) {
-		std::size_t change = image.shape()[0] / 3;
-		if (x1_i >= change)
-			x1_i -= change;
-		else
-			x1_i = 0;
-		x2_i += change;
-	}
-	if (y1_i == y2_i) {
-		std::size_t change = image.shape()[1] / 3;
-		if (y1_i >= change)
-			y1_i -= change;
-		else
-			y1_i = 0;
-		y2_i += change;
-	}
-
-	x1_i = std::min(x1_i, image.shape()[0] - 1);
-	x2_i = std::max(std::min(x2_i, image.shape()[0] - 1), x1_i);
-	y1_i = std::min(y1_i, image.shape()[1] - 1);
-	y2_i = std::max(std::min(y2_i, image.shape()[1] - 1), y1_i);
-
-	if (x1_i == x2_i || y1_i == y2_i)
-		return std::unique_ptr<libaction::Human>(new libaction::Human(human));
-
-	// Turn x2_i and y2_i into past-the-end indices.
-	x2_i++;
-	y2_i++;
-
-	auto cropped = libaction::detail::image::crop(image,
-		x1_i, y1_i, x2_i - x1_i, y2_i - y1_i);
+	std::size_t crop_x = 0, crop_y = 0;
+	auto cropped = detail::crop_region(image, x1, x2, y1, y2, crop_x, crop_y);
 
-	if (cropped->shape()[0] == 0 || cropped->shape()[1] == 0)
+	if (!cropped)
 		return std::unique_ptr<libaction::Human>(new libaction::Human(human));
 
 	auto cropped_human = estimator_callback(*cropped);
@@ -206,7 +270,7 @@ inline std::unique_ptr<libaction::Human> zoom_estimate(
 			auto coord = detail::coord_translate(
 				part.x(), part.y(),
 				image.shape()[0], image.shape()[1],
-				x1_i, y1_i,
+				crop_x, crop_y,
 				cropped->shape()[0], cropped->shape()[1]);
 
 			new_human->body_parts()[part.part_index()] = libaction::BodyPart(
@@ -218,7 +282,7 @@ inline std::unique_ptr<libaction::Human> zoom_estimate(
 			auto coord = detail::coord_translate(
 				part.x(), part.y(),
 				image.shape()[0], image.shape()[1],
-				x1_i, y1_i,
+				crop_x, crop_y,
 				cropped->shape()[0], cropped->shape()[1]);
 
 			find->second = libaction::BodyPart(
@@ -12,8 +12,11 @@
 #include "../../../human.hpp"
 #include "../../../detail/image.hpp"
 
+#include <boost/multi_array.hpp>
 #include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <stdexcept>
 #include <tuple>
 #include <utility>
 
@@ -58,6 +61,75 @@ inline std::pair<float, float> coord_translate(
 	return {x3, y3};
 }
 
+// Crop the region [x1, x2) * [y1, y2), in the coordinates of body parts, from
+// image. A region thinner than a pixel is widened by a third of the image.
+// Returns nullptr if the region is empty, otherwise the cropped image along
+// with its offset in crop_x and crop_y.
+template<typename Image>
+inline std::unique_ptr<boost::multi_array<typename Image::element, 3>>
+crop_region(
+	const Image &image,
+	float x1, float x2, float y1, float y2,
+	std::size_t &crop_x, std::size_t &crop_y
+) {
+	if (image.shape()[0] == 0 || image.shape()[1] == 0)
+		return nullptr;
+
+	x1 = std::max(x1, +0.0f);
+	x2 = std::min(x2, 1.0f);
+	y1 = std::max(y1, +0.0f);
+	y2 = std::min(y2, 1.0f);
+
+	std::size_t x1_i = static_cast<std::size_t>(x1 * static_cast<float>(image.shape()[0]));
+	std::size_t x2_i = static_cast<std::size_t>(x2 * static_cast<float>(image.shape()[0]));
+	std::size_t y1_i = static_cast<std::size_t>(y1 * static_cast<float>(image.shape()[1]));
+	std::size_t y2_i = static_cast<std::size_t>(y2 * static_cast<float>(image.shape()[1]));
+
+	x1_i = std::min(x1_i, image.shape()[0] - 1);
+	x2_i = std::max(std::min(x2_i, image.shape()[0] - 1), x1_i);
+	y1_i = std::min(y1_i, image.shape()[1] - 1);
+	y2_i = std::max(std::min(y2_i, image.shape()[1] - 1), y1_i);
+
+	if (x1_i == x2_i) {
+		std::size_t change = image.shape()[0] / 3;
+		if (x1_i >= change)
+			x1_i -= change;
+		else
+			x1_i = 0;
+		x2_i += change;
+	}
+	if (y1_i == y2_i) {
+		std::size_t change = image.shape()[1] / 3;
+		if (y1_i >= change)
+			y1_i -= change;
+		else
+			y1_i = 0;
+		y2_i += change;
+	}
+
+	x1_i = std::min(x1_i, image.shape()[0] - 1);
+	x2_i = std::max(std::min(x2_i, image.shape()[0] - 1), x1_i);
+	y1_i = std::min(y1_i, image.shape()[1] - 1);
+	y2_i = std::max(std::min(y2_i, image.shape()[1] - 1), y1_i);
+
+	if (x1_i == x2_i || y1_i == y2_i)
+		return nullptr;
+
+	// Turn x2_i and y2_i into past-the-end indices.
+	x2_i++;
+	y2_i++;
+
+	auto cropped = libaction::detail::image::crop(image,
+		x1_i, y1_i, x2_i - x1_i, y2_i - y1_i);
+
+	if (cropped->shape()[0] == 0 || cropped->shape()[1] == 0)
+		return nullptr;
+
+	crop_x = x1_i;
+	crop_y = y1_i;
+	return cropped;
+}
+
 }
 }
 }